@@ -0,0 +1,595 @@
+// bench.cpp
+//
+// Google Benchmark suite for the core routines of the cyborgs library.
+// The per-turn routines (the ArenaGrid cases) are parameterized over arena
+// size (rows == cols), cyborg count and wall density (in percent of the
+// empty cells, as Game::Game computes it), and construction and session
+// churn (GameGrid) over size and cyborg count.  The rest take their own
+// argument: a range for randInt, a channel count, a board size for the
+// topology build, a population for the cohort, real-time and history
+// cases, and a thread count for the planner.
+//
+// Emit JSON for regression tracking with, e.g.,
+//   cyborgs_bench --benchmark_out=bench.json --benchmark_out_format=json
+
+#include "cyborgs/cyborgs.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <iostream>
+#include <streambuf>
+#include <vector>
+using namespace std;
+using namespace cyborgs;
+
+
+///////////////////////////////////////////////////////////////////////////
+//  Fixture helpers
+///////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+    // Swallows everything written to it, so display() costs only formatting
+    class NullBuffer : public streambuf
+    {
+    protected:
+        int overflow(int ch) override { return ch; }
+        streamsize xsputn(const char*, streamsize n) override { return n; }
+    };
+
+    // Build an arena the same way Game::Game does, but with the wall
+    // density taken from the benchmark arguments instead of WALL_DENSITY.
+    Arena* makeArena(int size, int nCyborgs, int densityPct, int nChannels = MAXCHANNELS)
+    {
+        Arena* a = new Arena(size, size, nChannels);
+        int nEmpty = size * size - nCyborgs - 1;
+        int nWalls = static_cast<int>(densityPct / 100.0 * nEmpty);
+        while (nWalls > 0)
+        {
+            int r = randInt(1, size);
+            int c = randInt(1, size);
+            if (a->hasWallAt(r, c))
+                continue;
+            a->placeWallAt(r, c);
+            nWalls--;
+        }
+        a->buildTopology();
+        int rPlayer;
+        int cPlayer;
+        do
+        {
+            rPlayer = randInt(1, size);
+            cPlayer = randInt(1, size);
+        } while (a->hasWallAt(rPlayer, cPlayer));
+        a->addPlayer(rPlayer, cPlayer);
+        while (nCyborgs > 0)
+        {
+            int r = randInt(1, size);
+            int c = randInt(1, size);
+            if (a->hasWallAt(r, c) || (r == rPlayer && c == cPlayer))
+                continue;
+            a->addCyborg(r, c, randInt(1, nChannels));
+            nCyborgs--;
+        }
+        return a;
+    }
+
+    struct Cell
+    {
+        int r;
+        int c;
+    };
+
+    // A fixed cycle of random open cells, so the routine under test is not
+    // charged for the randInt calls that pick its arguments.
+    vector<Cell> openCells(const Arena& a, size_t n)
+    {
+        vector<Cell> cells;
+        while (cells.size() < n)
+        {
+            int r = randInt(1, a.rows());
+            int c = randInt(1, a.cols());
+            if (!a.hasWallAt(r, c))
+                cells.push_back({ r, c });
+        }
+        return cells;
+    }
+
+    const size_t CYCLE = 1024;
+
+    // Histories in the undo benchmarks: turns kept, and turns per keyframe
+    const int HISTORY_TURNS = 64;
+    const int HISTORY_KEYFRAMES = 32;
+
+    void setCounters(benchmark::State& state)
+    {
+        state.counters["size"] = static_cast<double>(state.range(0));
+        state.counters["cyborgs"] = static_cast<double>(state.range(1));
+        state.counters["walls_pct"] = static_cast<double>(state.range(2));
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+//  Benchmarks
+///////////////////////////////////////////////////////////////////////////
+
+static void BM_randInt(benchmark::State& state)
+{
+    int hi = static_cast<int>(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(randInt(1, hi));
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_attemptMove(benchmark::State& state)
+{
+    Arena* a = makeArena(state.range(0), state.range(1), state.range(2));
+    vector<Cell> cells = openCells(*a, CYCLE);
+    size_t k = 0;
+    for (auto _ : state)
+    {
+        Cell cell = cells[k % CYCLE];
+        benchmark::DoNotOptimize(attemptMove(*a, k % NUMDIRS, cell.r, cell.c));
+        benchmark::DoNotOptimize(cell);
+        k++;
+    }
+    setCounters(state);
+    delete a;
+}
+
+static void BM_CyborgForceMove(benchmark::State& state)
+{
+    Arena* a = makeArena(state.range(0), state.range(1), state.range(2));
+    vector<Cell> cells = openCells(*a, CYCLE);
+    vector<Cyborg> protos;
+    for (const Cell& cell : cells)
+        protos.push_back(Cyborg(a, cell.r, cell.c, 1));
+    size_t k = 0;
+    for (auto _ : state)
+    {
+        Cyborg cy = protos[k % CYCLE];
+        cy.forceMove(k % NUMDIRS);
+        benchmark::DoNotOptimize(cy);
+        k++;
+    }
+    setCounters(state);
+    delete a;
+}
+
+static void BM_CyborgMove(benchmark::State& state)
+{
+    Arena* a = makeArena(state.range(0), state.range(1), state.range(2));
+    vector<Cell> cells = openCells(*a, 1);
+    Cyborg cy(a, cells[0].r, cells[0].c, 1);
+    for (auto _ : state)
+    {
+        cy.move();
+        benchmark::DoNotOptimize(cy);
+    }
+    setCounters(state);
+    delete a;
+}
+
+static void BM_ArenaMoveCyborgs(benchmark::State& state)
+{
+    int size = state.range(0);
+    int nCyborgs = state.range(1);
+    int density = state.range(2);
+    Arena* a = makeArena(size, nCyborgs, density);
+    size_t k = 0;
+    for (auto _ : state)
+    {
+        // Broadcasts kill cyborgs; top the population back up off the clock
+        if (a->cyborgCount() < nCyborgs / 2 || a->cyborgCount() == 0)
+        {
+            state.PauseTiming();
+            delete a;
+            a = makeArena(size, nCyborgs, density);
+            state.ResumeTiming();
+        }
+        benchmark::DoNotOptimize(a->moveCyborgs(1 + k % MAXCHANNELS, k % NUMDIRS));
+        k++;
+    }
+    setCounters(state);
+    delete a;
+}
+
+// Broadcasts with MAXCYBORGS cyborgs spread over 1 to CHANNEL_LIMIT channels
+// on a MAXROWS x MAXCOLS board with 11% walls
+static void BM_ArenaMoveCyborgsChannels(benchmark::State& state)
+{
+    int nChannels = state.range(0);
+    Arena* a = makeArena(MAXROWS, MAXCYBORGS, 11, nChannels);
+    size_t k = 0;
+    for (auto _ : state)
+    {
+        if (a->cyborgCount() < MAXCYBORGS / 2)
+        {
+            state.PauseTiming();
+            delete a;
+            a = makeArena(MAXROWS, MAXCYBORGS, 11, nChannels);
+            state.ResumeTiming();
+        }
+        benchmark::DoNotOptimize(a->moveCyborgs(1 + k % nChannels, k % NUMDIRS));
+        k++;
+    }
+    state.counters["channels"] = nChannels;
+    state.SetItemsProcessed(state.iterations());
+    delete a;
+}
+
+static void BM_numberOfCyborgsAt(benchmark::State& state)
+{
+    Arena* a = makeArena(state.range(0), state.range(1), state.range(2));
+    vector<Cell> cells = openCells(*a, CYCLE);
+    size_t k = 0;
+    for (auto _ : state)
+    {
+        const Cell& cell = cells[k % CYCLE];
+        benchmark::DoNotOptimize(a->numberOfCyborgsAt(cell.r, cell.c));
+        k++;
+    }
+    setCounters(state);
+    delete a;
+}
+
+static void BM_recommendMove(benchmark::State& state)
+{
+    Arena* a = makeArena(state.range(0), state.range(1), state.range(2));
+    vector<Cell> cells = openCells(*a, CYCLE);
+    size_t k = 0;
+    for (auto _ : state)
+    {
+        const Cell& cell = cells[k % CYCLE];
+        int dir = BADDIR;
+        benchmark::DoNotOptimize(recommendMove(*a, cell.r, cell.c, dir));
+        benchmark::DoNotOptimize(dir);
+        k++;
+    }
+    setCounters(state);
+    delete a;
+}
+
+static void BM_ArenaDisplay(benchmark::State& state)
+{
+    Arena* a = makeArena(state.range(0), state.range(1), state.range(2));
+    NullBuffer nullBuf;
+    streambuf* saved = cout.rdbuf(&nullBuf);
+    for (auto _ : state)
+        a->display("Benchmark message.");
+    cout.rdbuf(saved);
+    setCounters(state);
+    delete a;
+}
+
+// What the simulation thread pays per turn to hand a frame to the renderer
+// (compare BM_ArenaDisplay, which is the in-line alternative)
+static void BM_FramePublish(benchmark::State& state)
+{
+    Arena* a = makeArena(state.range(0), state.range(1), state.range(2));
+    FrameBuffer frames;
+    long long turn = 0;
+    for (auto _ : state)
+    {
+        Frame& f = frames.back();
+        renderGrid(*a, f.grid);
+        f.turn = ++turn;
+        f.cyborgs = a->cyborgCount();
+        f.playerDead = a->player()->isDead();
+        frames.publish();
+        frames.acquire();
+    }
+    setCounters(state);
+    delete a;
+}
+
+// Building the wall topology of a size x size board with 11% walls, on
+// every core
+static void BM_WallTopology(benchmark::State& state)
+{
+    int size = static_cast<int>(state.range(0));
+    size_t nCells = static_cast<size_t>(size) * size;
+    vector<char> grid(nCells);
+    seedRandom(36);
+    for (size_t i = 0; i < nCells; i++)
+        grid[i] = (randInt(0, 99) < 11);
+    bool* walls = new bool[nCells];
+    for (size_t i = 0; i < nCells; i++)
+        walls[i] = (grid[i] != 0);
+    int regions = 0;
+    double bytes = 0;
+    for (auto _ : state)
+    {
+        WallTopology t(walls, size, size);
+        regions = t.regionCount();
+        bytes = static_cast<double>(t.memoryUsed());
+    }
+    state.counters["size"] = size;
+    state.counters["regions"] = regions;
+    state.counters["bytes"] = bytes;
+    state.counters["cells_per_second"] = benchmark::Counter(
+        static_cast<double>(nCells) * state.iterations(), benchmark::Counter::kIsRate);
+    delete[] walls;
+}
+
+static void BM_GameConstruction(benchmark::State& state)
+{
+    int size = state.range(0);
+    int nCyborgs = state.range(1);
+    for (auto _ : state)
+    {
+        Game g(size, size, nCyborgs);
+        benchmark::DoNotOptimize(&g);
+    }
+    state.counters["size"] = size;
+    state.counters["cyborgs"] = nCyborgs;
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Session churn the unpooled way: a fresh Arena and Session every time
+static void BM_SessionChurnHeap(benchmark::State& state)
+{
+    int size = state.range(0);
+    int nCyborgs = state.range(1);
+    unsigned int seed = 1;
+    for (auto _ : state)
+    {
+        Arena* a = new Arena(size, size);
+        Session* s = new Session(*a, nCyborgs, seed++);
+        benchmark::DoNotOptimize(s);
+        delete s;
+        delete a;
+    }
+    state.counters["size"] = size;
+    state.counters["cyborgs"] = nCyborgs;
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Session churn through SessionHost's arena and session pools
+static void BM_SessionChurnPooled(benchmark::State& state)
+{
+    int size = state.range(0);
+    int nCyborgs = state.range(1);
+    SessionHost host;
+    unsigned int seed = 1;
+    for (auto _ : state)
+    {
+        int id = host.open(size, size, nCyborgs, seed++);
+        host.close(id);
+    }
+    state.counters["size"] = size;
+    state.counters["cyborgs"] = nCyborgs;
+    state.counters["bytes_per_session"] = static_cast<double>(host.totalMemory());
+    state.SetItemsProcessed(state.iterations());
+}
+
+// One broadcast per iteration in aggregate mode on a MAXROWS x MAXCOLS
+// board with 11% walls, at populations far beyond MAXCYBORGS
+static void BM_CohortMoveCyborgs(benchmark::State& state)
+{
+    long long nCyborgs = state.range(0);
+    Arena* a = makeArena(MAXROWS, MAXCYBORGS, 11);
+    CohortArena* ca = nullptr;
+    size_t k = 0;
+    for (auto _ : state)
+    {
+        if (ca == nullptr || ca->cyborgCount() < nCyborgs / 2)
+        {
+            state.PauseTiming();
+            delete ca;
+            ca = new CohortArena(*a);
+            while (ca->cyborgCount() < nCyborgs)
+                ca->addCyborgs(randInt(1, MAXROWS), randInt(1, MAXCOLS),
+                    randInt(1, MAXCHANNELS), (nCyborgs + 99) / 100);
+            state.ResumeTiming();
+        }
+        benchmark::DoNotOptimize(ca->moveCyborgs(1 + k % MAXCHANNELS, k % NUMDIRS));
+        k++;
+    }
+    state.counters["cyborgs"] = static_cast<double>(nCyborgs);
+    state.counters["cohorts"] = ca->cohortCount();
+    state.SetItemsProcessed(state.iterations());
+    delete ca;
+    delete a;
+}
+
+// The work of one real-time tick with no input (the advisor's move, a
+// broadcast to nobody and a view of the player's surroundings) on a square
+// board with room for twice the cyborgs.  At 20 Hz the budget is 50 ms.
+static void BM_RealtimeTick(benchmark::State& state)
+{
+    int nCyborgs = static_cast<int>(state.range(0));
+    int size = static_cast<int>(sqrt(2.0 * nCyborgs)) + 1;
+    seedRandom(35);
+    Arena a(size, size, MAXCHANNELS, nCyborgs);
+    populateArena(a, nCyborgs);
+    a.sortCyborgs();
+    Player* p = a.player();
+    string view;
+    for (auto _ : state)
+    {
+        int dir;
+        if (!p->isDead() && recommendMove(a, p->row(), p->col(), dir))
+            p->move(dir);
+        a.moveCyborgs(0, BADDIR);
+        renderView(a, p->row() - 10, p->col() - 30, 20, 60, view);
+        benchmark::DoNotOptimize(view.data());
+    }
+    state.counters["cyborgs"] = nCyborgs;
+    state.SetItemsProcessed(state.iterations());
+}
+
+// A broadcast turn with range(0) cyborgs on a board twice their number,
+// recorded into a history when range(1) is 1 and not when it is 0
+static void BM_ArenaHistoryRecord(benchmark::State& state)
+{
+    int nCyborgs = static_cast<int>(state.range(0));
+    int size = static_cast<int>(sqrt(2.0 * nCyborgs)) + 1;
+    seedRandom(37);
+    Arena start(size, size, MAXCHANNELS, nCyborgs);
+    populateArena(start, nCyborgs);
+    start.sortCyborgs();
+    Arena a(1, 1);
+    size_t k = 0;
+    for (auto _ : state)
+    {
+        // Broadcasts kill cyborgs; start over off the clock
+        if (a.cyborgCount() < nCyborgs / 2 || a.cyborgCount() == 0)
+        {
+            state.PauseTiming();
+            a.copyFrom(start);
+            if (state.range(1) != 0)
+                a.enableHistory(HISTORY_TURNS, HISTORY_KEYFRAMES);
+            state.ResumeTiming();
+        }
+        benchmark::DoNotOptimize(a.moveCyborgs(1 + k % MAXCHANNELS, k % NUMDIRS));
+        k++;
+    }
+    state.counters["cyborgs"] = nCyborgs;
+    if (a.history() != nullptr)
+    {
+        const TurnHistory* h = a.history();
+        state.counters["bytes_per_turn"] = static_cast<double>(h->delta(h->turn() - 1).bytes());
+        state.counters["history_bytes"] = static_cast<double>(h->memoryUsed());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Undo and redo, one turn an iteration, back and forth across a full
+// history of broadcast turns with range(0) cyborgs
+static void BM_ArenaUndoRedo(benchmark::State& state)
+{
+    int nCyborgs = static_cast<int>(state.range(0));
+    int size = static_cast<int>(sqrt(2.0 * nCyborgs)) + 1;
+    seedRandom(37);
+    Arena a(size, size, MAXCHANNELS, nCyborgs);
+    populateArena(a, nCyborgs);
+    a.sortCyborgs();
+    a.enableHistory(HISTORY_TURNS, HISTORY_KEYFRAMES);
+    for (int t = 0; t < HISTORY_TURNS; t++)
+        a.moveCyborgs(1 + t % MAXCHANNELS, t % NUMDIRS);
+    const TurnHistory* h = a.history();
+    bool back = true;
+    for (auto _ : state)
+    {
+        if (back ? !a.undoTurn() : !a.redoTurn())
+            back = !back;
+    }
+    size_t bytes = 0;
+    for (long long t = h->oldestTurn(); t < h->newestTurn(); t++)
+        bytes += h->delta(t).bytes();
+    state.counters["cyborgs"] = nCyborgs;
+    state.counters["bytes_per_turn"] = static_cast<double>(bytes) / (h->newestTurn() - h->oldestTurn());
+    state.counters["history_bytes"] = static_cast<double>(h->memoryUsed());
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Seeks between the two ends of a full history of 10000-cyborg turns, with
+// a keyframe every range(0) turns
+static void BM_ArenaSeek(benchmark::State& state)
+{
+    int nCyborgs = 10000;
+    int size = static_cast<int>(sqrt(2.0 * nCyborgs)) + 1;
+    seedRandom(37);
+    Arena a(size, size, MAXCHANNELS, nCyborgs);
+    populateArena(a, nCyborgs);
+    a.enableHistory(HISTORY_TURNS, static_cast<int>(state.range(0)));
+    for (int t = 0; t < HISTORY_TURNS; t++)
+        a.moveCyborgs(1 + t % MAXCHANNELS, t % NUMDIRS);
+    const TurnHistory* h = a.history();
+    size_t k = 0;
+    for (auto _ : state)
+    {
+        // Near each end, but not on a keyframe
+        a.seekTurn(k % 2 == 0 ? h->oldestTurn() + 3 : h->newestTurn() - 3);
+        k++;
+    }
+    state.counters["keyframe_interval"] = static_cast<double>(state.range(0));
+    state.counters["history_bytes"] = static_cast<double>(h->memoryUsed());
+    state.SetItemsProcessed(state.iterations());
+}
+
+// A full planner search on a game-style 10x10 board with 5 cyborgs.  The
+// time budget is left unlimited so the benchmark measures search
+// throughput; win_probability reports how good the resulting plan is.
+static void BM_PlanBroadcasts(benchmark::State& state)
+{
+    seedRandom(33);
+    Arena* a = new Arena(10, 10);
+    populateArena(*a, 5);
+    PlannerOptions opts;
+    opts.horizon = 32;
+    opts.threads = state.range(0);
+    opts.timeBudget = 1e9;
+    Plan plan;
+    long long turns = 0;
+    for (auto _ : state)
+    {
+        plan = planBroadcasts(*a, opts);
+        turns += plan.simulatedTurns;
+    }
+    state.counters["threads"] = opts.threads;
+    state.counters["win_probability"] = plan.winProbability;
+    state.counters["plan_steps"] = static_cast<double>(plan.steps.size());
+    state.counters["turns_per_second"] = benchmark::Counter(static_cast<double>(turns), benchmark::Counter::kIsRate);
+    delete a;
+}
+
+///////////////////////////////////////////////////////////////////////////
+//  Parameter grid
+///////////////////////////////////////////////////////////////////////////
+
+// {size, cyborgs, wall density %}; sizes and counts stay within MAXROWS,
+// MAXCOLS and MAXCYBORGS, and every combination leaves room for the player.
+static void ArenaGrid(benchmark::internal::Benchmark* b)
+{
+    b->ArgNames({ "size", "cyborgs", "walls" });
+    const int sizes[] = { 5, 10, MAXROWS };
+    const int counts[] = { 4, 20, MAXCYBORGS };
+    const int densities[] = { 0, 11, 30 };
+    for (int size : sizes)
+        for (int n : counts)
+        {
+            if (n > size * size / 2)
+                continue;
+            for (int d : densities)
+                b->Args({ size, n, d });
+        }
+}
+
+static void GameGrid(benchmark::internal::Benchmark* b)
+{
+    b->ArgNames({ "size", "cyborgs" });
+    const int sizes[] = { 5, 10, MAXROWS };
+    const int counts[] = { 4, 20, MAXCYBORGS };
+    for (int size : sizes)
+        for (int n : counts)
+            if (n <= size * size / 2)
+                b->Args({ size, n });
+}
+
+BENCHMARK(BM_randInt)->Arg(3)->Arg(MAXROWS);
+BENCHMARK(BM_attemptMove)->Apply(ArenaGrid);
+BENCHMARK(BM_CyborgForceMove)->Apply(ArenaGrid);
+BENCHMARK(BM_CyborgMove)->Apply(ArenaGrid);
+BENCHMARK(BM_ArenaMoveCyborgs)->Apply(ArenaGrid);
+BENCHMARK(BM_ArenaMoveCyborgsChannels)->Arg(1)->Arg(MAXCHANNELS)->Arg(12)->Arg(CHANNEL_LIMIT);
+BENCHMARK(BM_numberOfCyborgsAt)->Apply(ArenaGrid);
+BENCHMARK(BM_recommendMove)->Apply(ArenaGrid);
+BENCHMARK(BM_WallTopology)->Arg(MAXROWS)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ArenaDisplay)->Apply(ArenaGrid);
+BENCHMARK(BM_FramePublish)->Apply(ArenaGrid);
+BENCHMARK(BM_GameConstruction)->Apply(GameGrid);
+BENCHMARK(BM_SessionChurnHeap)->Apply(GameGrid);
+BENCHMARK(BM_SessionChurnPooled)->Apply(GameGrid);
+BENCHMARK(BM_CohortMoveCyborgs)->RangeMultiplier(100)->Range(MAXCYBORGS, 1000000);
+BENCHMARK(BM_RealtimeTick)->RangeMultiplier(100)->Range(MAXCYBORGS, 1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ArenaHistoryRecord)->ArgsProduct({ { MAXCYBORGS, 10000, 1000000 }, { 0, 1 } })
+    ->ArgNames({ "cyborgs", "history" });
+BENCHMARK(BM_ArenaUndoRedo)->RangeMultiplier(100)->Range(MAXCYBORGS, 1000000);
+BENCHMARK(BM_ArenaSeek)->Arg(8)->Arg(HISTORY_TURNS);
+BENCHMARK(BM_PlanBroadcasts)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
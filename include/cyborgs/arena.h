@@ -0,0 +1,303 @@
+// arena.h
+//
+// Core simulation state: the Arena and the Cyborgs and Player living in it.
+//
+// An Arena keeps its cyborgs grouped by channel: channel ch occupies one
+// contiguous range of the cyborg array, in channel order.  A broadcast then
+// runs one tight loop over the addressed channel's range and another over
+// everything else, without testing each cyborg's channel.
+//
+// Moves consult the arena's WallTopology rather than the wall grid.  It is
+// built on first use after the walls last changed and shared by copies, so
+// build it (buildTopology or topology) before sharing an arena between
+// threads.  When no copy shares it, it is rebuilt in place, so an arena
+// reset for game after game keeps reusing the same tables.
+//
+// With enableHistory, each moveCyborgs is recorded as a turn in a
+// TurnHistory (see history.h) that undoTurn, redoTurn and seekTurn play
+// back.  A turn starts at beginTurn, before the player moves, or else at
+// moveCyborgs; changing the arena any other way forgets the history.
+
+#ifndef CYBORGS_ARENA_INCLUDED
+#define CYBORGS_ARENA_INCLUDED
+
+#include "constants.h"
+#include "history.h"
+#include "memory.h"
+#include "topology.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cyborgs
+{
+
+///////////////////////////////////////////////////////////////////////////
+// Type definitions
+///////////////////////////////////////////////////////////////////////////
+
+class Arena;  // This is needed to let the compiler know that Arena is a
+              // type name, since it's mentioned in the Cyborg declaration.
+
+class Cyborg
+{
+public:
+    // Constructor
+    Cyborg(Arena* ap, int r, int c, int channel);
+
+    // Accessors
+    int  row() const;
+    int  col() const;
+    int  channel() const;
+    int  health() const;
+    bool isDead() const;
+
+    // Mutators
+    void forceMove(int dir);
+    void move();
+
+private:
+    friend class Arena;  // the broadcast and random-walk kernels
+
+    Arena* m_arena;
+    int    m_row;
+    int    m_col;
+    int    m_channel;
+    int    m_health;
+};
+
+class Player
+{
+public:
+    // Constructor
+    Player(Arena* ap, int r, int c);
+
+    // Accessors
+    int  row() const;
+    int  col() const;
+    bool isDead() const;
+
+    // Mutators
+    std::string stand();
+    std::string move(int dir);
+    void        setDead();
+
+private:
+    friend class Arena;  // undo puts it back
+
+    Arena* m_arena;
+    int    m_row;
+    int    m_col;
+    bool   m_dead;
+};
+
+class Arena
+{
+public:
+    // Constructor/destructor
+    Arena(int nRows, int nCols, int nChannels = MAXCHANNELS, int maxCyborgs = MAXCYBORGS);
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Accessors
+    int           rows() const;
+    int           cols() const;
+    int           channels() const;
+    Player*       player() const;
+    int           cyborgCount() const;
+    int           maxCyborgs() const;
+    int           cyborgCountOn(int channel) const;
+    const Cyborg& cyborg(int i) const;  // 0 <= i < cyborgCount(), by channel
+    bool          hasWallAt(int r, int c) const;
+    const WallTopology& topology() const;  // builds it if the walls changed
+    std::shared_ptr<const WallTopology> sharedTopology() const;
+    int           numberOfCyborgsAt(int r, int c) const;
+    void          display(std::string msg) const;
+    std::size_t   memoryUsed() const;  // this object, its block and history,
+                                       // and its topology unless shared
+    const TurnHistory* history() const;  // null unless enabled
+
+    // Mutators
+    void        placeWallAt(int r, int c);
+    void        buildTopology(int nThreads = 0);  // 0: one thread per core
+    bool        addCyborg(int r, int c, int channel);
+    bool        addPlayer(int r, int c);
+    std::string moveCyborgs(int channel, int dir);  // channel 0: nobody
+    void        reset(int nRows, int nCols, int nChannels = MAXCHANNELS,
+                      int maxCyborgs = MAXCYBORGS);  // empty arena
+    void        copyFrom(const Arena& other);  // become a snapshot of other
+    void        sortCyborgs();  // by cell within each channel, for locality
+    void        enableHistory(int maxTurns, int keyframeInterval = 32);  // 0: off
+    void        beginTurn();  // before the player moves
+    bool        undoTurn();   // false if there is nothing to undo
+    bool        redoTurn();
+    bool        seekTurn(long long turn);  // to any turn history() holds
+
+private:
+    // Walls, cyborgs and the player all live in m_memory, so reset() is a
+    // rewind plus clearing the wall grid
+    BumpAllocator m_memory;
+    bool*         m_wallGrid;  // m_rows * m_cols, row-major
+    int           m_rows;
+    int           m_cols;
+    int           m_nChannels;
+    Player*       m_player;
+    Cyborg*       m_cyborgs;   // m_maxCyborgs slots, the first m_nCyborgs live
+    int           m_nCyborgs;
+    int           m_maxCyborgs;
+    int*          m_channelStart;  // channel ch is [m_channelStart[ch],
+                                   // m_channelStart[ch + 1]); m_nChannels + 2
+    mutable std::shared_ptr<WallTopology> m_topology;  // null until built
+    mutable bool  m_topologyCurrent;  // false once the walls change
+    std::unique_ptr<TurnHistory> m_history;  // null unless recording
+
+    // Helper functions
+    void checkPos(int r, int c, const char* functionName) const;
+    bool isPosInBounds(int r, int c) const;
+    void updateTopology(int nThreads) const;  // in place unless shared
+
+    // The turn's kernels.  steps, unless null, gets each cyborg's step code
+    // by index, and removed, unless null, gets the dead.
+    void pushCyborgs(int begin, int end, int dir, unsigned char* steps);  // broadcast
+    void walkCyborgs(int begin, int end, unsigned char* steps);           // random walk
+    int  removeDead(int channel, std::vector<CyborgRecord>* removed);     // -> number removed
+
+    // Undo and redo
+    void         undoDelta(const TurnDelta& d);
+    void         redoDelta(const TurnDelta& d);
+    void         restoreDead(int channel, const std::vector<CyborgRecord>& removed);
+    void         restoreCyborg(int i, const CyborgRecord& r, int channel);
+    void         restoreKeyframe(const TurnDelta& d);
+    PlayerRecord playerRecord() const;
+    void         restorePlayer(const PlayerRecord& p);
+    void         forgetHistory();  // the arena changed outside a turn
+    [[noreturn]] void reportBadPos(int r, int c, const char* functionName) const;
+};
+
+///////////////////////////////////////////////////////////////////////////
+//  Inline implementations
+///////////////////////////////////////////////////////////////////////////
+
+inline int Cyborg::row() const
+{
+    return m_row;
+}
+
+inline int Cyborg::col() const
+{
+    return m_col;
+}
+
+inline int Cyborg::channel() const
+{
+    return m_channel;
+}
+
+inline int Cyborg::health() const
+{
+    return m_health;
+}
+
+inline bool Cyborg::isDead() const
+{
+    return m_health <= 0;
+}
+
+inline int Player::row() const
+{
+    return m_row;
+}
+
+inline int Player::col() const
+{
+    return m_col;
+}
+
+inline bool Player::isDead() const
+{
+    return m_dead;
+}
+
+inline int Arena::rows() const
+{
+    return m_rows;
+}
+
+inline int Arena::cols() const
+{
+    return m_cols;
+}
+
+inline int Arena::channels() const
+{
+    return m_nChannels;
+}
+
+inline Player* Arena::player() const
+{
+    return m_player;
+}
+
+inline int Arena::cyborgCount() const
+{
+    return m_nCyborgs;
+}
+
+inline int Arena::maxCyborgs() const
+{
+    return m_maxCyborgs;
+}
+
+inline int Arena::cyborgCountOn(int channel) const
+{
+    if (channel < 1 || channel > m_nChannels)
+        return 0;
+    return m_channelStart[channel + 1] - m_channelStart[channel];
+}
+
+inline const Cyborg& Arena::cyborg(int i) const
+{
+    return m_cyborgs[i];
+}
+
+inline bool Arena::hasWallAt(int r, int c) const
+{
+    checkPos(r, c, "Arena::hasWallAt");
+    return m_wallGrid[(r - 1) * m_cols + (c - 1)];
+}
+
+inline const TurnHistory* Arena::history() const
+{
+    return m_history.get();
+}
+
+inline const WallTopology& Arena::topology() const
+{
+    if (!m_topologyCurrent)
+        updateTopology(0);
+    return *m_topology;
+}
+
+inline std::shared_ptr<const WallTopology> Arena::sharedTopology() const
+{
+    topology();
+    return m_topology;
+}
+
+inline bool Arena::isPosInBounds(int r, int c) const
+{
+    return (r >= 1 && r <= m_rows && c >= 1 && c <= m_cols);
+}
+
+inline void Arena::checkPos(int r, int c, const char* functionName) const
+{
+    if (!isPosInBounds(r, c))
+        reportBadPos(r, c, functionName);
+}
+
+}  // namespace cyborgs
+
+#endif  // CYBORGS_ARENA_INCLUDED
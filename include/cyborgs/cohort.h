@@ -0,0 +1,78 @@
+// cohort.h
+//
+// Aggregate ("cohort") cyborg population.  Instead of one object per
+// cyborg, a CohortArena stores how many cyborgs share each (cell, channel,
+// health).  A broadcast moves a responding cohort as one unit; a random move
+// splits a cohort multinomially over the four directions.  A turn therefore
+// costs O(occupied cohorts) however many cyborgs there are, and its outcome
+// has the same distribution as Arena::moveCyborgs on the same population.
+//
+// A CohortArena shares an Arena's wall topology and copies its player and
+// cyborgs when it is built, and from then on runs on its own; it is not
+// limited to MAXCYBORGS.  Its lookup tables take O(rows * cols * channels *
+// health) space, so it is meant for crowded boards rather than huge sparse
+// ones.
+
+#ifndef CYBORGS_COHORT_INCLUDED
+#define CYBORGS_COHORT_INCLUDED
+
+#include "topology.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cyborgs
+{
+
+class Arena;
+
+class CohortArena
+{
+public:
+    // Constructor
+    explicit CohortArena(const Arena& a);
+
+    // Accessors
+    int       rows() const;
+    int       cols() const;
+    long long cyborgCount() const;
+    long long numberOfCyborgsAt(int r, int c) const;
+    int       cohortCount() const;
+    bool      isPlayerDead() const;
+    bool      hasWallAt(int r, int c) const;
+
+    // Mutators
+    bool        addCyborgs(int r, int c, int channel, long long count);
+    std::string moveCyborgs(int channel, int dir);
+
+private:
+    struct Cohort
+    {
+        int       cell;     // (r - 1) * m_cols + (c - 1)
+        int       channel;
+        int       health;
+        long long count;
+    };
+
+    int                      m_rows;
+    int                      m_cols;
+    int                      m_channels;
+    std::shared_ptr<const WallTopology> m_topology;  // the Arena's
+    int                      m_playerCell;  // -1 if no player
+    bool                     m_playerDead;
+    long long                m_nCyborgs;
+    std::vector<Cohort>      m_cohorts;
+    std::vector<Cohort>      m_next;      // scratch for moveCyborgs
+    std::vector<int>         m_slot;      // (cell, channel, health) -> cohort
+    std::vector<unsigned>    m_stamp;     // m_slot entry valid iff == m_gen
+    unsigned                 m_gen;
+
+    int  neighbor(int cell, int dir) const;  // -1 if blocked
+    void emit(int cell, int channel, int health, long long count);
+    void beginTurn();
+};
+
+}  // namespace cyborgs
+
+#endif  // CYBORGS_COHORT_INCLUDED
@@ -0,0 +1,32 @@
+// constants.h
+
+#ifndef CYBORGS_CONSTANTS_INCLUDED
+#define CYBORGS_CONSTANTS_INCLUDED
+
+namespace cyborgs
+{
+
+///////////////////////////////////////////////////////////////////////////
+// Manifest constants
+///////////////////////////////////////////////////////////////////////////
+
+const int MAXROWS = 20;              // max number of rows in a game
+const int MAXCOLS = 20;              // max number of columns in a game
+const int MAXCYBORGS = 100;          // max number of cyborgs in a game
+const int MAXUNDO = 1000;            // turns a game can undo
+const int ARENA_MAXDIM = 16384;      // max rows or columns in any Arena
+const int MAXCHANNELS = 3;           // number of channels by default
+const int CHANNEL_LIMIT = 35;        // max channels in an arena (1-9, A-Z)
+const int INITIAL_CYBORG_HEALTH = 3; // initial cyborg health
+const double WALL_DENSITY = 0.11;    // density of walls
+
+const int NORTH = 0;
+const int EAST = 1;
+const int SOUTH = 2;
+const int WEST = 3;
+const int NUMDIRS = 4;
+const int BADDIR = -1;
+
+}  // namespace cyborgs
+
+#endif  // CYBORGS_CONSTANTS_INCLUDED
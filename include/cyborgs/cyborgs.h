@@ -0,0 +1,28 @@
+// cyborgs.h
+//
+// Umbrella header for the cyborgs simulation library.
+
+#ifndef CYBORGS_INCLUDED
+#define CYBORGS_INCLUDED
+
+#define CYBORGS_VERSION_MAJOR 1
+#define CYBORGS_VERSION_MINOR 0
+
+#include "constants.h"
+#include "rng.h"
+#include "topology.h"
+#include "history.h"
+#include "arena.h"
+#include "rules.h"
+#include "render.h"
+#include "game.h"
+#include "memory.h"
+#include "pool.h"
+#include "session.h"
+#include "cohort.h"
+#include "planner.h"
+#include "frames.h"
+#include "soak.h"
+#include "realtime.h"
+
+#endif  // CYBORGS_INCLUDED
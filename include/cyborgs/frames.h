@@ -0,0 +1,124 @@
+// frames.h
+//
+// Rendering off the simulation thread.  The simulation fills a Frame (a
+// rendered grid plus counters) and publishes it into a FrameBuffer, a
+// lock-free triple buffer: publishing never waits, and the reader always
+// takes the newest frame, so frames it was too slow for are dropped rather
+// than queued.  RenderThread is that reader; it draws at most maxFps frames
+// a second, so a slow terminal holds up only the render thread.
+
+#ifndef CYBORGS_FRAMES_INCLUDED
+#define CYBORGS_FRAMES_INCLUDED
+
+#include <atomic>
+#include <iosfwd>
+#include <string>
+#include <thread>
+
+namespace cyborgs
+{
+
+struct Frame
+{
+    std::string grid;        // as produced by renderGrid
+    long long   turn;        // turns simulated so far
+    long long   game;        // games started so far
+    int         cyborgs;
+    bool        playerDead;
+};
+
+// One writer thread, one reader thread
+class FrameBuffer
+{
+public:
+    // Constructor
+    FrameBuffer();
+    FrameBuffer(const FrameBuffer&) = delete;
+    FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+    // Writer side
+    Frame&    back();     // fill this in, then publish()
+    void      publish();
+    long long published() const;
+
+    // Reader side
+    bool         acquire();     // true if a newer frame is now front()
+    const Frame& front() const;
+
+private:
+    static const int FRESH = 4;  // set in m_middle when it holds a new frame
+    static const int INDEX = 3;
+
+    Frame            m_frames[3];
+    int              m_back;     // writer's
+    int              m_front;    // reader's
+    std::atomic<int> m_middle;   // index | FRESH, swapped between them
+    std::atomic<long long> m_published;
+};
+
+class RenderThread
+{
+public:
+    // Constructor/destructor.  Draws to out, clearing the screen first
+    // when out is cout; maxFps > 0.
+    RenderThread(FrameBuffer& frames, std::ostream& out, double maxFps);
+    ~RenderThread();
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // Accessors
+    long long framesDrawn() const;
+
+    // Mutators
+    void start();
+    void stop();  // draws the last frame, then joins
+
+private:
+    FrameBuffer&           m_frames;
+    std::ostream&          m_out;
+    double                 m_maxFps;
+    std::thread            m_thread;
+    std::atomic<bool>      m_running;
+    std::atomic<long long> m_drawn;
+
+    // Helper functions
+    void run();
+    void draw(const Frame& f);
+};
+
+///////////////////////////////////////////////////////////////////////////
+//  Inline implementations
+///////////////////////////////////////////////////////////////////////////
+
+inline Frame& FrameBuffer::back()
+{
+    return m_frames[m_back];
+}
+
+inline void FrameBuffer::publish()
+{
+    m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX;
+    m_published.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline long long FrameBuffer::published() const
+{
+    return m_published.load(std::memory_order_relaxed);
+}
+
+inline bool FrameBuffer::acquire()
+{
+    if ((m_middle.load(std::memory_order_relaxed) & FRESH) == 0)
+        return false;
+    m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX;
+    return true;
+}
+
+inline const Frame& FrameBuffer::front() const
+{
+    return m_frames[m_front];
+}
+
+}  // namespace cyborgs
+
+#endif  // CYBORGS_FRAMES_INCLUDED
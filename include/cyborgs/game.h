@@ -0,0 +1,49 @@
+// game.h
+//
+// The interactive game: sets up a random Arena and runs the turn loop on
+// cin/cout.
+
+#ifndef CYBORGS_GAME_INCLUDED
+#define CYBORGS_GAME_INCLUDED
+
+#include "constants.h"
+
+#include <string>
+
+namespace cyborgs
+{
+
+class Arena;
+
+class Game
+{
+public:
+    // Constructor/destructor
+    Game(int rows, int cols, int nCyborgs, int nChannels = MAXCHANNELS);
+    ~Game();
+    Game(const Game&) = delete;
+    Game& operator=(const Game&) = delete;
+
+    // Accessors
+    Arena& arena() const;
+
+    // Mutators
+    void play();
+
+private:
+    Arena* m_arena;
+    bool   m_inputClosed;  // set when cin runs dry mid-game
+
+    // Helper functions
+    std::string takePlayerTurn();
+    std::string takeCyborgsTurn();
+};
+
+// Randomly place walls (WALL_DENSITY of the free cells), the player and
+// nCyborgs cyborgs on random channels (1..a.channels()) into an empty
+// arena, exactly as Game does.  The arena must have room for all of them.
+void populateArena(Arena& a, int nCyborgs);
+
+}  // namespace cyborgs
+
+#endif  // CYBORGS_GAME_INCLUDED
@@ -0,0 +1,135 @@
+// history.h
+//
+// Undo and redo for an Arena.  A turn is kept as a delta from the state
+// before it: for each cyborg, by its index before the turn's removals, the
+// step it took and whether it lost health; the cyborgs the broadcast
+// destroyed; and the player before and after.  Cyborgs move at most one
+// step a turn, so a step is one byte, and a turn costs one byte per cyborg
+// plus a CyborgRecord per destroyed one.  Undo plays a delta backwards and
+// redo forwards, in O(cyborgs in the turn); the walls never enter into it.
+//
+// Deltas live in a ring of up to maxTurns slots, added as turns are played,
+// whose buffers are reused; so the history's memory is bounded by maxTurns
+// times the largest turn, and the oldest turn is forgotten to make room for
+// a new one.  Every keyframeInterval turns a slot also keeps a copy of every
+// cyborg as the turn began, so seeking many turns away replays at most
+// keyframeInterval deltas from the nearest keyframe rather than every turn
+// in between.
+
+#ifndef CYBORGS_HISTORY_INCLUDED
+#define CYBORGS_HISTORY_INCLUDED
+
+#include "constants.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace cyborgs
+{
+
+const int STEP_STAY = NUMDIRS;  // step code: the cyborg did not move
+const int STEP_DIR = 7;         // mask for the direction, or STEP_STAY
+const int STEP_HURT = 8;        // or'ed in: it lost a point of health
+
+struct CyborgRecord
+{
+    int index;  // in the cyborg array
+    int row;
+    int col;
+    int health;
+};
+
+struct PlayerRecord
+{
+    int  row;
+    int  col;
+    bool dead;
+};
+
+struct TurnDelta
+{
+    std::vector<unsigned char> steps;     // step code per cyborg
+    int                        channel;   // whose dead were removed, or 0
+    std::vector<CyborgRecord>  removed;   // as they died; ascending index
+    PlayerRecord               playerBefore;
+    PlayerRecord               playerAfter;
+    bool                       keyframe;
+    std::vector<CyborgRecord>  snapshot;      // keyframes: every cyborg
+    std::vector<int>           channelStart;  // keyframes: the ranges
+
+    std::size_t bytes() const;  // recorded, not counting spare capacity
+};
+
+class TurnHistory
+{
+public:
+    // Constructor.  maxTurns >= 1 and keyframeInterval >= 1.
+    TurnHistory(int maxTurns, int keyframeInterval);
+
+    // Accessors.  Turns are counted from when the history began; the
+    // delta for turn t takes the arena from turn() == t to t + 1.
+    long long        turn() const;        // turns played, less those undone
+    long long        oldestTurn() const;  // the earliest turn() reachable
+    long long        newestTurn() const;  // the latest turn() reachable
+    int              maxTurns() const;
+    int              keyframeInterval() const;
+    const TurnDelta& delta(long long t) const;  // oldestTurn() <= t < newestTurn()
+    long long        keyframeBefore(long long t) const;  // latest kept
+                                       // keyframe turn <= t, or -1 if none
+    std::size_t      memoryUsed() const;  // this object and its buffers
+
+    // Mutators, for the Arena being recorded
+    void       beginTurn(const PlayerRecord& player);  // before the player moves
+    TurnDelta& recordTurn(const PlayerRecord& player); // a new turn(); drops
+                                       // any redo.  Fill it in at once.
+    void       setTurn(long long t);   // after the arena is moved to turn t
+    void       clear();                // forget every turn; turn() stays
+
+private:
+    std::vector<TurnDelta> m_ring;     // turn t in m_ring[t % m_maxTurns]
+    int                    m_maxTurns;
+    int                    m_keyframeInterval;
+    long long              m_turn;
+    long long              m_oldest;
+    long long              m_newest;
+    bool                   m_begun;    // m_pending holds the player
+    PlayerRecord           m_pending;
+};
+
+///////////////////////////////////////////////////////////////////////////
+//  Inline implementations
+///////////////////////////////////////////////////////////////////////////
+
+inline long long TurnHistory::turn() const
+{
+    return m_turn;
+}
+
+inline long long TurnHistory::oldestTurn() const
+{
+    return m_oldest;
+}
+
+inline long long TurnHistory::newestTurn() const
+{
+    return m_newest;
+}
+
+inline int TurnHistory::maxTurns() const
+{
+    return m_maxTurns;
+}
+
+inline int TurnHistory::keyframeInterval() const
+{
+    return m_keyframeInterval;
+}
+
+inline const TurnDelta& TurnHistory::delta(long long t) const
+{
+    return m_ring[t % m_maxTurns];
+}
+
+}  // namespace cyborgs
+
+#endif  // CYBORGS_HISTORY_INCLUDED
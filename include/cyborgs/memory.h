@@ -0,0 +1,96 @@
+// memory.h
+//
+// A bump ("arena") allocator: one block, handed out front to back and freed
+// all at once by reset().  An Arena carves its wall grid, cyborgs and player
+// out of its own BumpAllocator, so setting up or resetting an Arena costs
+// no per-object new/delete once the block is big enough.
+
+#ifndef CYBORGS_MEMORY_INCLUDED
+#define CYBORGS_MEMORY_INCLUDED
+
+#include <cstddef>
+#include <new>
+
+namespace cyborgs
+{
+
+class BumpAllocator
+{
+public:
+    // Constructor/destructor
+    BumpAllocator();
+    ~BumpAllocator();
+    BumpAllocator(const BumpAllocator&) = delete;
+    BumpAllocator& operator=(const BumpAllocator&) = delete;
+
+    // Accessors
+    std::size_t used() const;
+    std::size_t capacity() const;
+
+    // Mutators
+    void* allocate(std::size_t bytes, std::size_t align);
+    void  reset(std::size_t minCapacity);  // free everything; grow if too small
+
+    template<typename T>
+    T* allocateArray(std::size_t n)
+    {
+        return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+private:
+    char*       m_block;
+    std::size_t m_used;
+    std::size_t m_capacity;
+
+    [[noreturn]] void reportExhausted(std::size_t bytes) const;
+};
+
+///////////////////////////////////////////////////////////////////////////
+//  Inline implementations
+///////////////////////////////////////////////////////////////////////////
+
+inline BumpAllocator::BumpAllocator()
+{
+    m_block = nullptr;
+    m_used = 0;
+    m_capacity = 0;
+}
+
+inline BumpAllocator::~BumpAllocator()
+{
+    ::operator delete(m_block);
+}
+
+inline std::size_t BumpAllocator::used() const
+{
+    return m_used;
+}
+
+inline std::size_t BumpAllocator::capacity() const
+{
+    return m_capacity;
+}
+
+inline void* BumpAllocator::allocate(std::size_t bytes, std::size_t align)
+{
+    std::size_t start = (m_used + align - 1) & ~(align - 1);
+    if (start + bytes > m_capacity)
+        reportExhausted(bytes);
+    m_used = start + bytes;
+    return m_block + start;
+}
+
+inline void BumpAllocator::reset(std::size_t minCapacity)
+{
+    if (minCapacity > m_capacity)
+    {
+        ::operator delete(m_block);
+        m_block = static_cast<char*>(::operator new(minCapacity));
+        m_capacity = minCapacity;
+    }
+    m_used = 0;
+}
+
+}  // namespace cyborgs
+
+#endif  // CYBORGS_MEMORY_INCLUDED
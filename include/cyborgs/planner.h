@@ -0,0 +1,61 @@
+// planner.h
+//
+// Broadcast planner: searches for a sequence of broadcasts that destroys
+// every cyborg before one reaches the player, which is the puzzle
+// takeCyborgsTurn leaves to the user.  A broadcast's outcome is random (the
+// willRespond coin, and the random moves of cyborgs it doesn't address),
+// so a candidate plan is judged on a set of sampled futures ("particles")
+// rather than one.  Beam search keeps the most promising plans at each
+// depth; all candidates at a depth replay the same dice, so they are
+// compared on equal terms.  The player is assumed to follow recommendMove,
+// as it does in Game when the user enters nothing.
+//
+// Candidates are simulated in parallel on Arena snapshots (Arena::copyFrom)
+// by threads started once per search, each with a scratch arena of its
+// own, and the whole search, including the final estimate of the chosen
+// plan's win probability, stops at the time budget.
+
+#ifndef CYBORGS_PLANNER_INCLUDED
+#define CYBORGS_PLANNER_INCLUDED
+
+#include <vector>
+
+namespace cyborgs
+{
+
+class Arena;
+
+struct PlanStep
+{
+    int channel;
+    int dir;
+};
+
+struct PlannerOptions
+{
+    int          horizon = 64;        // longest plan considered
+    int          beamWidth = 16;      // plans kept at each depth
+    int          particles = 32;      // sampled futures per plan
+    int          evalRollouts = 2000; // fresh rollouts to score the result
+    int          threads = 0;         // 0 means one per hardware thread
+    double       timeBudget = 1.0;    // seconds, search plus evaluation
+    unsigned int seed = 1;
+};
+
+struct Plan
+{
+    std::vector<PlanStep> steps;               // empty if the game is over
+    double                winProbability = 0;  // over the rollouts
+    int                   rollouts = 0;        // evaluation rollouts completed
+    int                   depthSearched = 0;   // deepest level fully expanded
+    long long             simulatedTurns = 0;  // search and evaluation
+    bool                  timedOut = false;    // the budget cut it short
+};
+
+// Plan broadcasts for a, whose player has just moved.  a is not modified,
+// and neither is the calling thread's random engine.
+Plan planBroadcasts(const Arena& a, const PlannerOptions& opts = PlannerOptions());
+
+}  // namespace cyborgs
+
+#endif  // CYBORGS_PLANNER_INCLUDED
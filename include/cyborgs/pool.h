@@ -0,0 +1,44 @@
+// pool.h
+//
+// Recycles Arenas.  release() keeps an Arena and its memory block on a free
+// list; acquire() hands it back out after Arena::reset, which is O(cells)
+// and allocates nothing unless the new size needs a bigger block.
+
+#ifndef CYBORGS_POOL_INCLUDED
+#define CYBORGS_POOL_INCLUDED
+
+#include "constants.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace cyborgs
+{
+
+class Arena;
+
+class ArenaPool
+{
+public:
+    // Constructor/destructor
+    ArenaPool();
+    ~ArenaPool();
+    ArenaPool(const ArenaPool&) = delete;
+    ArenaPool& operator=(const ArenaPool&) = delete;
+
+    // Accessors
+    int         idleCount() const;
+    std::size_t idleMemory() const;  // bytes held by idle arenas
+
+    // Mutators
+    Arena* acquire(int rows, int cols, int nChannels = MAXCHANNELS);  // empty,
+                                         // owned by the caller
+    void   release(Arena* a);            // give it back for reuse
+
+private:
+    std::vector<Arena*> m_idle;
+};
+
+}  // namespace cyborgs
+
+#endif  // CYBORGS_POOL_INCLUDED
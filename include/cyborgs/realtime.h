@@ -0,0 +1,63 @@
+// realtime.h
+//
+// Real-time play: the arena ticks at a fixed rate whether or not anyone
+// types.  Keys are read without blocking (raw terminal mode and poll() on
+// POSIX, _kbhit on Windows) and take effect at the next tick: n/e/s/w move
+// the player and x stands; a channel symbol followed by a direction
+// broadcasts (e.g. 2 then n); q quits.  A tick without a player key
+// follows recommendMove, and one without a broadcast sends a broadcast to
+// channel 0, which addresses nobody, so every cyborg just wanders.
+//
+// Frames go through a FrameBuffer to a RenderThread, so drawing never
+// delays a tick.  The loop measures how late each tick starts (jitter)
+// and how long its work takes against the tick budget.
+
+#ifndef CYBORGS_REALTIME_INCLUDED
+#define CYBORGS_REALTIME_INCLUDED
+
+#include "constants.h"
+
+#include <iosfwd>
+
+namespace cyborgs
+{
+
+struct RealtimeOptions
+{
+    int          rows = MAXROWS;
+    int          cols = MAXCOLS;
+    int          cyborgs = 20;      // any number the board has room for
+    int          channels = MAXCHANNELS;
+    double       hz = 20;
+    long long    maxTicks = 0;      // 0: until the game ends or q; otherwise
+                                    // exactly this many, even past the end
+    int          viewRows = 20;     // window drawn around the player
+    int          viewCols = 60;
+    unsigned int seed = 1;
+};
+
+struct TickStats
+{
+    long long ticks;
+    long long overruns;      // ticks whose work took longer than budgetMs
+    double    budgetMs;      // 1000 / hz
+    double    meanWorkMs;
+    double    p99WorkMs;
+    double    worstWorkMs;
+    double    meanJitterMs;  // how late a tick started
+    double    p99JitterMs;
+    double    worstJitterMs;
+    long long playerKeys;    // ticks that used a key rather than the advisor
+    long long broadcasts;    // ticks that used a typed broadcast
+    bool      won;
+    bool      lost;
+};
+
+// Play in real time on stdin/out, drawing to out; returns the tick stats
+TickStats playRealtime(const RealtimeOptions& opts, std::ostream& out);
+
+void printTickStats(const TickStats& stats, std::ostream& out);
+
+}  // namespace cyborgs
+
+#endif  // CYBORGS_REALTIME_INCLUDED
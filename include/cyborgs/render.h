@@ -0,0 +1,47 @@
+// render.h
+//
+// Text rendering of an Arena.  Arena::display is the interactive wrapper
+// (clear the terminal, then draw to cout); embedders can render into any
+// stream or string instead.
+
+#ifndef CYBORGS_RENDER_INCLUDED
+#define CYBORGS_RENDER_INCLUDED
+
+#include "arena.h"
+
+#include <iosfwd>
+#include <string>
+
+namespace cyborgs
+{
+
+// Replace out with the arena grid, one '\n'-terminated line per row:
+// '*' wall, '.' empty, a channel symbol for cyborgs, '@' or 'X' for the
+// live or dead player
+void renderGrid(const Arena& a, std::string& out);
+
+// Like renderGrid, but only the nRows x nCols window whose top left corner
+// is (top, left), clipped to the arena; for arenas too big for a terminal
+void renderView(const Arena& a, int top, int left, int nRows, int nCols, std::string& out);
+
+// '1'..'9' for channels 1-9, then 'A'..'Z' up to CHANNEL_LIMIT
+char channelSymbol(int channel);
+
+// Write the grid followed by msg (if any) and the cyborg/player status lines
+void renderArena(const Arena& a, const std::string& msg, std::ostream& out);
+
+// Clear the terminal (or write a newline where that isn't possible)
+void clearScreen();
+
+///////////////////////////////////////////////////////////////////////////
+//  Inline implementations
+///////////////////////////////////////////////////////////////////////////
+
+inline char channelSymbol(int channel)
+{
+    return static_cast<char>(channel < 10 ? '0' + channel : 'A' + channel - 10);
+}
+
+}  // namespace cyborgs
+
+#endif  // CYBORGS_RENDER_INCLUDED
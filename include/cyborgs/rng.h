@@ -0,0 +1,54 @@
+// rng.h
+//
+// The random number source shared by the whole simulation.  Everything that
+// rolls dice (cyborg moves, the broadcast coin, Game setup) goes through
+// randInt, so seeding this one engine makes a run reproducible.  Each thread
+// has its own engine, so simulations can run in parallel with their own
+// seeds.
+
+#ifndef CYBORGS_RNG_INCLUDED
+#define CYBORGS_RNG_INCLUDED
+
+#include <random>
+#include <utility>
+
+namespace cyborgs
+{
+
+// The calling thread's engine behind randInt, seeded from
+// std::random_device on first use
+inline std::default_random_engine& randomEngine()
+{
+    static thread_local std::default_random_engine generator(std::random_device{}());
+    return generator;
+}
+
+// Restart the calling thread's engine from a known seed
+inline void seedRandom(unsigned int seed)
+{
+    randomEngine().seed(seed);
+}
+
+// Derive an independent seed for step n of a run seeded with seed
+// (splitmix64 finalizer), so each step's dice never depend on how many
+// rolls earlier steps used
+inline unsigned int mixSeed(unsigned int seed, unsigned long long n)
+{
+    unsigned long long x = seed + 0x9E3779B97F4A7C15ULL * (n + 1);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return static_cast<unsigned int>(x ^ (x >> 31));
+}
+
+// Return a random int from min to max, inclusive
+inline int randInt(int min, int max)
+{
+    if (max < min)
+        std::swap(max, min);
+    std::uniform_int_distribution<> distro(min, max);
+    return distro(randomEngine());
+}
+
+}  // namespace cyborgs
+
+#endif  // CYBORGS_RNG_INCLUDED
@@ -0,0 +1,51 @@
+// rules.h
+//
+// Movement rules and the move advisor.  attemptMove sits on the hot path of
+// every random cyborg step, so it is defined inline here; both read the
+// arena's WallTopology rather than probing the wall grid.
+
+#ifndef CYBORGS_RULES_INCLUDED
+#define CYBORGS_RULES_INCLUDED
+
+#include "arena.h"
+#include "constants.h"
+
+namespace cyborgs
+{
+
+///////////////////////////////////////////////////////////////////////////
+//  Auxiliary function declarations
+///////////////////////////////////////////////////////////////////////////
+
+// Map 'n', 'e', 's' or 'w' to a direction, or BADDIR for anything else
+int decodeDirection(char ch);
+
+// Map a channel symbol ('1'..'9', then 'A'..'Z' in either case) to its
+// channel number, or 0 for anything else
+int decodeChannel(char ch);
+
+// Move (r,c) one step in dir unless that would leave the arena or enter a
+// wall; return whether the step was taken
+bool attemptMove(const Arena& a, int dir, int& r, int& c);
+
+// Recommend a move for a player at (r,c); false means standing is best
+bool recommendMove(const Arena& a, int r, int c, int& bestDir);
+
+///////////////////////////////////////////////////////////////////////////
+//  Inline implementations
+///////////////////////////////////////////////////////////////////////////
+
+inline bool attemptMove(const Arena& a, int dir, int& r, int& c)
+{
+    if (dir < 0 || dir >= NUMDIRS)
+        return true;  // no direction: nothing to refuse
+    if ((a.topology().moves(r, c) & (1 << dir)) == 0)
+        return false;
+    r += (dir == SOUTH) - (dir == NORTH);
+    c += (dir == EAST) - (dir == WEST);
+    return true;
+}
+
+}  // namespace cyborgs
+
+#endif  // CYBORGS_RULES_INCLUDED
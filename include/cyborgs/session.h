@@ -0,0 +1,109 @@
+// session.h
+//
+// One lockstep multiplayer game.  Commands from any number of clients are
+// queued between ticks; step() applies them in a fixed order with the RNG
+// reseeded from (seed, tick), so the same commands and seed always produce
+// the same arena no matter how they arrived.  Each tick yields a compact
+// delta of the grid cells that changed instead of a full frame.
+// SessionHost runs many sessions over pooled memory.
+//
+// Wire format of the strings produced here (one '\n'-terminated line each):
+//   F <tick> <rows> <cols> <cyborgs> <row1>/<row2>/.../<rowN>   full frame
+//   D <tick> <cyborgs> <n> [<r> <c> <ch>]*n                     delta
+//   E WIN | E LOSE                                              game over
+
+#ifndef CYBORGS_SESSION_INCLUDED
+#define CYBORGS_SESSION_INCLUDED
+
+#include "constants.h"
+#include "pool.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace cyborgs
+{
+
+class Arena;
+
+class Session
+{
+public:
+    // Constructor/destructor.  The session plays in arena, which must be
+    // empty, no bigger than MAXROWS by MAXCOLS, and outlive it; populating
+    // it is part of starting the session.
+    Session(Arena& arena, int nCyborgs, unsigned int seed);
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    // Accessors
+    const Arena& arena() const;
+    long         tick() const;
+    bool         isOver() const;
+    void         snapshot(std::string& out) const;  // append an F line
+    std::size_t  memoryUsed() const;  // this session plus its arena
+
+    // Mutators
+    void submitPlayerMove(int dir);  // BADDIR means stand; last one wins
+    void submitBroadcast(int member, int channel, int dir);  // member: the
+                                     // sender's join order in the session
+    bool step(std::string& out);     // append D (and E) lines; false if idle
+    void restart(Arena& arena, int nCyborgs, unsigned int seed);  // reuse
+
+private:
+    friend class SessionHost;  // takes m_arena back to its pool
+
+    struct Broadcast
+    {
+        int member;
+        int channel;
+        int dir;
+    };
+
+    Arena*                 m_arena;
+    unsigned int           m_seed;
+    long                   m_tick;
+    bool                   m_hasPlayerMove;
+    int                    m_playerMove;
+    std::vector<Broadcast> m_broadcasts;
+    std::string            m_grid;     // grid as of the last delta
+    std::string            m_scratch;  // grid being compared against it
+};
+
+// Hosts many sessions at once.  Arenas come from an ArenaPool, each
+// rebuilding its wall topology in place, and closed Session objects are
+// kept for reuse, so once the host has warmed up, opening and closing
+// sessions allocates nothing.  (A topology's working space still grows the
+// first time a board has more wall runs or regions than any before it.)
+class SessionHost
+{
+public:
+    // Constructor/destructor
+    SessionHost();
+    ~SessionHost();
+    SessionHost(const SessionHost&) = delete;
+    SessionHost& operator=(const SessionHost&) = delete;
+
+    // Accessors
+    Session*    find(int id) const;  // nullptr unless id is open
+    int         sessionCount() const;
+    std::size_t memoryUsed(int id) const;  // 0 unless id is open
+    std::size_t totalMemory() const;       // open sessions plus idle pool
+
+    // Mutators
+    int  open(int rows, int cols, int nCyborgs, unsigned int seed,
+              int nChannels = MAXCHANNELS);  // -> id
+    void close(int id);
+
+private:
+    ArenaPool             m_arenas;
+    std::vector<Session*> m_slots;    // session id - 1 -> session or nullptr
+    std::vector<Session*> m_idle;     // closed sessions awaiting reuse
+    std::vector<int>      m_freeIds;
+    int                   m_nOpen;
+};
+
+}  // namespace cyborgs
+
+#endif  // CYBORGS_SESSION_INCLUDED
@@ -0,0 +1,49 @@
+// soak.h
+//
+// Soak runs: the simulation plays game after game unattended, with the
+// player following recommendMove and random broadcasts, for a fixed time.
+// With asyncRender the grid is drawn by a RenderThread from published
+// frames, so the simulation never waits on the terminal; otherwise every
+// turn is drawn in line, as Game::play does, for comparison.
+
+#ifndef CYBORGS_SOAK_INCLUDED
+#define CYBORGS_SOAK_INCLUDED
+
+#include "constants.h"
+
+#include <iosfwd>
+
+namespace cyborgs
+{
+
+struct SoakOptions
+{
+    int          rows = 10;
+    int          cols = 10;
+    int          cyborgs = 20;
+    int          channels = MAXCHANNELS;
+    double       seconds = 5;     // > 0
+    bool         asyncRender = true;
+    double       maxFps = 30;     // > 0; only async rendering is limited
+    unsigned int seed = 1;
+};
+
+struct SoakStats
+{
+    long long turns;
+    long long games;
+    long long wins;
+    long long framesPublished;   // async only: one per turn
+    long long framesDrawn;
+    double    seconds;           // wall time actually run
+};
+
+// Run a soak, drawing to out; returns what happened
+SoakStats runSoak(const SoakOptions& opts, std::ostream& out);
+
+// Summarize: turns/s against drawn fps, and frames dropped
+void printSoakStats(const SoakStats& stats, std::ostream& out);
+
+}  // namespace cyborgs
+
+#endif  // CYBORGS_SOAK_INCLUDED
@@ -0,0 +1,124 @@
+// topology.h
+//
+// What the walls imply, computed once after they are placed: for every
+// cell a 4-bit mask of the directions a step may take, and the connected
+// open region it belongs to.  Walls never change during a game, so an Arena
+// builds this once and its copies share it.
+//
+// Only the masks are kept per cell.  Regions are kept per horizontal run of
+// open cells, and a cell's region is found by searching its row's runs; the
+// distance to a wall is walked along the masks when asked for.  That keeps a
+// 10000 x 10000 board to a few bytes a cell.
+//
+// The build makes one pass over the grid, split into bands of rows across
+// threads.  Each band finds its runs and joins those that touch with a
+// union-find; the bands are then stitched together along their edges.
+//
+// rebuild recomputes everything for new walls in the same object, reusing
+// its tables and the build's working space when they are big enough, so an
+// arena reused for game after game stops allocating for its topology.
+
+#ifndef CYBORGS_TOPOLOGY_INCLUDED
+#define CYBORGS_TOPOLOGY_INCLUDED
+
+#include "constants.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace cyborgs
+{
+
+class WallTopology
+{
+public:
+    // Constructor.  walls is nRows * nCols, row-major; nThreads 0 means
+    // one per core, and small grids use one thread regardless.
+    WallTopology(const bool* walls, int nRows, int nCols, int nThreads = 0);
+    WallTopology(const WallTopology&) = delete;
+    WallTopology& operator=(const WallTopology&) = delete;
+
+    // Accessors.  Cells are (r,c) from (1,1), as in Arena.
+    int         rows() const;
+    int         cols() const;
+    int         moves(int r, int c) const;  // bit dir set if a step dir is open
+    int         wallDistance(int r, int c, int dir) const;  // open cells to pass
+    int         region(int r, int c) const;  // 1..regionCount(); 0 for a wall
+    int         regionCount() const;
+    long long   regionSize(int region) const;  // open cells in it
+    int         largestRegion() const;         // 0 if there are no open cells
+    const unsigned char* moveMasks() const;    // row-major, for hot loops
+    std::size_t memoryUsed() const;
+
+    // Mutators
+    void rebuild(const bool* walls, int nRows, int nCols, int nThreads = 0);
+
+private:
+    // The masks are filled by the threads that first touch them, so they
+    // are not zeroed up front as a vector's would be
+    int                              m_rows;
+    int                              m_cols;
+    std::unique_ptr<unsigned char[]> m_moves;     // per cell
+    std::size_t                      m_capacity;  // cells m_moves holds
+    std::vector<int>                 m_rowFirstRun;  // per row, and one past
+    std::vector<int>                 m_runStart;     // by run, in cell order
+    std::vector<int>                 m_runLength;
+    std::vector<int>                 m_runRegion;
+    std::vector<long long>           m_regionSize;   // by region; [0] unused
+    int                              m_largest;
+
+    // Working space for the build, kept for the next rebuild.  Band 0
+    // builds straight into the run tables; the others are copied after it.
+    std::vector<std::vector<int> > m_bandStart;   // per row band, by run
+    std::vector<std::vector<int> > m_bandLength;
+    std::vector<std::vector<int> > m_bandParent;
+    std::vector<std::vector<int> > m_bandRow;     // where a row's runs are
+    std::vector<int>               m_firstRun;    // per row band
+    std::vector<int>               m_firstId;
+    std::vector<int>               m_parent;      // by run, across bands
+    std::vector<int>               m_touched;
+};
+
+///////////////////////////////////////////////////////////////////////////
+//  Inline implementations
+///////////////////////////////////////////////////////////////////////////
+
+inline int WallTopology::rows() const
+{
+    return m_rows;
+}
+
+inline int WallTopology::cols() const
+{
+    return m_cols;
+}
+
+inline int WallTopology::moves(int r, int c) const
+{
+    return m_moves[static_cast<std::size_t>(r - 1) * m_cols + (c - 1)];
+}
+
+inline int WallTopology::regionCount() const
+{
+    return static_cast<int>(m_regionSize.size()) - 1;
+}
+
+inline long long WallTopology::regionSize(int region) const
+{
+    return m_regionSize[region];
+}
+
+inline int WallTopology::largestRegion() const
+{
+    return m_largest;
+}
+
+inline const unsigned char* WallTopology::moveMasks() const
+{
+    return m_moves.get();
+}
+
+}  // namespace cyborgs
+
+#endif  // CYBORGS_TOPOLOGY_INCLUDED
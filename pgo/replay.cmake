@@ -0,0 +1,13 @@
+# Replays the recorded interactive session in WORKLOAD against the game
+# binary GAME, REPEAT times.  Each game is freshly randomized, so repeated
+# runs spread the profile over many different arenas.
+
+foreach(i RANGE 1 ${REPEAT})
+    execute_process(COMMAND ${GAME}
+        INPUT_FILE ${WORKLOAD}
+        OUTPUT_QUIET
+        RESULT_VARIABLE rc)
+    if(NOT rc EQUAL 0)
+        message(FATAL_ERROR "Replay ${i} of ${WORKLOAD} failed: ${rc}")
+    endif()
+endforeach()
@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+"""Compare Google Benchmark JSON files against a baseline.
+
+usage: compare_bench.py baseline.json variant.json [variant.json ...]
+
+Prints each benchmark's baseline CPU time and, for every variant, the ratio
+variant/baseline (below 1.00 is faster), followed by the geometric mean.
+"""
+
+import json
+import math
+import os
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    return {b["name"]: b["cpu_time"] for b in data["benchmarks"]
+            if b.get("run_type", "iteration") == "iteration"}
+
+
+def main(argv):
+    if len(argv) < 3:
+        sys.exit(__doc__)
+    base = load(argv[1])
+    names = [os.path.splitext(os.path.basename(p))[0] for p in argv[2:]]
+    variants = [load(p) for p in argv[2:]]
+
+    width = max(len(n) for n in base)
+    print("%-*s %12s" % (width, "benchmark", "base ns") +
+          "".join(" %8s" % n for n in names))
+    logs = [[] for _ in variants]
+    for bench, t in base.items():
+        row = "%-*s %12.1f" % (width, bench, t)
+        for i, v in enumerate(variants):
+            if bench in v and t > 0:
+                ratio = v[bench] / t
+                logs[i].append(math.log(ratio))
+                row += " %8.2f" % ratio
+            else:
+                row += " %8s" % "-"
+        print(row)
+    print("%-*s %12s" % (width, "geomean", "") +
+          "".join(" %8.2f" % math.exp(sum(l) / len(l)) if l else " %8s" % "-"
+                  for l in logs))
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,49 @@
+#!/bin/sh
+# Builds the plain, LTO, PGO and -march=native Release variants side by
+# side and runs the same benchmark selection against each, then prints
+# every variant's times relative to the plain build.
+#
+# usage: scripts/compare_builds.sh [benchmark filter regex] [output dir]
+
+set -e
+
+FILTER=${1:-'/size:20/'}
+OUT=${2:-_variants}
+SRC=$(cd "$(dirname "$0")/.." && pwd)
+JOBS=$(nproc 2>/dev/null || echo 2)
+MIN_TIME=${MIN_TIME:-0.2}
+
+mkdir -p "$OUT"
+OUT=$(cd "$OUT" && pwd)
+
+build()
+{
+    name=$1
+    shift
+    cmake -S "$SRC" -B "$OUT/$name" -DCMAKE_BUILD_TYPE=Release "$@" > /dev/null
+    cmake --build "$OUT/$name" -j"$JOBS" > /dev/null
+}
+
+run()
+{
+    name=$1
+    "$OUT/$name/cyborgs_bench" --benchmark_filter="$FILTER" \
+        --benchmark_min_time="$MIN_TIME" \
+        --benchmark_out="$OUT/$name.json" --benchmark_out_format=json > /dev/null 2>&1
+}
+
+echo "== plain";  build plain;  run plain
+echo "== lto";    build lto -DCYBORGS_LTO=ON;    run lto
+echo "== native"; build native -DCYBORGS_NATIVE=ON; run native
+
+# PGO is two-stage in one build tree so the profile matches the objects
+echo "== pgo"
+rm -rf "$OUT/pgo/pgo-profile"
+build pgo -DCYBORGS_PGO=GENERATE -DCYBORGS_LTO=ON
+cmake --build "$OUT/pgo" --target pgo-train > /dev/null 2>&1
+cmake -S "$SRC" -B "$OUT/pgo" -DCYBORGS_PGO=USE > /dev/null
+cmake --build "$OUT/pgo" --clean-first -j"$JOBS" > /dev/null
+run pgo
+
+python3 "$SRC/scripts/compare_bench.py" "$OUT/plain.json" \
+    "$OUT/lto.json" "$OUT/native.json" "$OUT/pgo.json"
@@ -0,0 +1,608 @@
+// server.cpp
+//
+// Lockstep multiplayer server (Linux, epoll).  Clients connect over a Unix
+// domain socket or loopback TCP and speak a line protocol:
+//
+//   NEW [<rows> <cols> <cyborgs>]   create a session and control its player
+//   JOIN <id>                       join a session; the first member controls
+//                                   the player, the rest broadcast on channels
+//                                   1..--channels in turn
+//   M <n|e|s|w|x>                   player move for the next tick
+//   B <n|e|s|w>                     broadcast on your channel next tick
+//   STATS                           "STATS <sessions> <bytes> [<yours>]":
+//                                   open sessions, host memory, and your
+//                                   session's memory
+//   QUIT
+//
+// Replies are "OK <id> PLAYER" or "OK <id> CHANNEL <k>" followed by a full
+// frame, then one delta per tick in which the session changed, and "ERR ..."
+// for bad commands, including moves and broadcasts once the game is over.  See cyborgs/session.h for the frame and delta format.
+//
+// Every session has its own Arena, recycled through a SessionHost when the
+// session ends.  Commands are only queued as they
+// arrive; a timerfd fires at the tick rate and steps each session that has
+// pending commands, so all sessions advance in lockstep on one thread.
+
+#include "cyborgs/arena.h"
+#include "cyborgs/constants.h"
+#include "cyborgs/rules.h"
+#include "cyborgs/session.h"
+
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+using namespace std;
+using namespace cyborgs;
+
+namespace
+{
+
+const size_t MAX_LINE = 256;          // longest command accepted
+const size_t MAX_PENDING_OUT = 1 << 20;  // drop clients this far behind
+
+struct Options
+{
+    string       unixPath;
+    int          port = 0;
+    int          hz = 10;
+    int          rows = MAXROWS;
+    int          cols = MAXCOLS;
+    int          cyborgs = 20;
+    int          channels = MAXCHANNELS;
+    unsigned int seed = 1;
+};
+
+struct Client
+{
+    int    fd;
+    int    session = -1;  // -1 until NEW/JOIN
+    int    channel = 0;   // 0 controls the player
+    int    member = 0;    // join order in the session, for ordering broadcasts
+    string in;
+    string out;
+    bool   watchingOut = false;
+    bool   dropped = false;  // closed once the current event is handled
+};
+
+struct SessionEntry
+{
+    vector<int>         members;  // client fds
+    bool                hasController = false;
+    int                 nextChannel = 1;
+    int                 nextMember = 0;
+};
+
+class Server
+{
+public:
+    explicit Server(const Options& opts);
+    int run();
+
+private:
+    Options                               m_opts;
+    int                                   m_epoll = -1;
+    int                                   m_listen = -1;
+    int                                   m_timer = -1;
+    unordered_map<int, Client>            m_clients;
+    SessionHost                           m_host;
+    unordered_map<int, SessionEntry>      m_sessions;
+    unordered_set<int>                    m_dirty;  // sessions with commands queued
+    vector<int>                           m_dropped;  // clients to close
+    unsigned int                          m_nextSeed = 1;
+
+    bool listenOn();
+    void accept();
+    void readFrom(Client& cl);
+    void flush(Client& cl);
+    void send(Client& cl, const string& s);
+    void drop(Client& cl);
+    void reap();
+    void close(int fd);
+    void handle(Client& cl, const string& line);
+    void join(Client& cl, int id);
+    void tick();
+    void watch(int fd, uint32_t events, int op);
+};
+
+///////////////////////////////////////////////////////////////////////////
+//  Server implementation
+///////////////////////////////////////////////////////////////////////////
+
+Server::Server(const Options& opts)
+    : m_opts(opts)
+{
+}
+
+void Server::watch(int fd, uint32_t events, int op)
+{
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(m_epoll, op, fd, &ev) != 0)
+        perror("epoll_ctl");
+}
+
+bool Server::listenOn()
+{
+    if (!m_opts.unixPath.empty())
+    {
+        m_listen = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (m_opts.unixPath.size() >= sizeof(addr.sun_path))
+        {
+            cerr << "Socket path too long: " << m_opts.unixPath << endl;
+            return false;
+        }
+        strcpy(addr.sun_path, m_opts.unixPath.c_str());
+        unlink(addr.sun_path);
+        if (m_listen < 0 || bind(m_listen, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+        {
+            perror("bind");
+            return false;
+        }
+    }
+    else
+    {
+        m_listen = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        setsockopt(m_listen, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(m_opts.port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (m_listen < 0 || bind(m_listen, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+        {
+            perror("bind");
+            return false;
+        }
+    }
+    if (listen(m_listen, SOMAXCONN) != 0)
+    {
+        perror("listen");
+        return false;
+    }
+    return true;
+}
+
+int Server::run()
+{
+    // Thousands of sessions need thousands of descriptors
+    rlimit lim;
+    if (getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur < lim.rlim_max)
+    {
+        lim.rlim_cur = lim.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &lim);
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll < 0 || !listenOn())
+        return 1;
+    watch(m_listen, EPOLLIN, EPOLL_CTL_ADD);
+
+    m_timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    itimerspec period{};
+    long ns = 1000000000L / m_opts.hz;
+    period.it_interval.tv_sec = ns / 1000000000L;
+    period.it_interval.tv_nsec = ns % 1000000000L;
+    period.it_value = period.it_interval;
+    timerfd_settime(m_timer, 0, &period, nullptr);
+    watch(m_timer, EPOLLIN, EPOLL_CTL_ADD);
+
+    cerr << "cyborgs_server listening on "
+        << (m_opts.unixPath.empty() ? "127.0.0.1:" + to_string(m_opts.port) : m_opts.unixPath)
+        << " at " << m_opts.hz << " ticks/s" << endl;
+
+    vector<epoll_event> events(1024);
+    for (;;)
+    {
+        int n = epoll_wait(m_epoll, events.data(), static_cast<int>(events.size()), -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("epoll_wait");
+            return 1;
+        }
+        for (int i = 0; i < n; i++)
+        {
+            int fd = events[i].data.fd;
+            if (fd == m_listen)
+                accept();
+            else if (fd == m_timer)
+            {
+                uint64_t expirations;
+                while (read(m_timer, &expirations, sizeof(expirations)) > 0)
+                    ;
+                tick();
+            }
+            else
+            {
+                auto it = m_clients.find(fd);
+                if (it == m_clients.end())
+                    continue;
+                if (events[i].events & (EPOLLHUP | EPOLLERR))
+                {
+                    close(fd);
+                    continue;
+                }
+                if (events[i].events & EPOLLIN)
+                    readFrom(it->second);
+                if (!it->second.dropped && (events[i].events & EPOLLOUT))
+                    flush(it->second);
+            }
+
+            // Handlers hold Client and SessionEntry references, so clients
+            // are only marked while they run and closed here
+            reap();
+        }
+    }
+}
+
+void Server::accept()
+{
+    for (;;)
+    {
+        int fd = accept4(m_listen, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                perror("accept");
+            return;
+        }
+        if (m_opts.unixPath.empty())
+        {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        Client cl;
+        cl.fd = fd;
+        m_clients.emplace(fd, move(cl));
+        watch(fd, EPOLLIN, EPOLL_CTL_ADD);
+    }
+}
+
+void Server::readFrom(Client& cl)
+{
+    int fd = cl.fd;
+    char buf[4096];
+    for (;;)
+    {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n == 0)
+        {
+            drop(cl);
+            return;
+        }
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                drop(cl);
+                return;
+            }
+            break;
+        }
+        cl.in.append(buf, static_cast<size_t>(n));
+    }
+
+    size_t start = 0;
+    size_t nl;
+    while ((nl = cl.in.find('\n', start)) != string::npos)
+    {
+        string line = cl.in.substr(start, nl - start);
+        start = nl + 1;
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        handle(cl, line);
+        if (cl.dropped)
+            return;  // QUIT or a failed send
+    }
+    cl.in.erase(0, start);
+    if (cl.in.size() > MAX_LINE)
+    {
+        send(cl, "ERR line too long\n");
+        drop(cl);
+    }
+}
+
+void Server::handle(Client& cl, const string& line)
+{
+    istringstream iss(line);
+    string cmd;
+    iss >> cmd;
+    if (cmd == "QUIT")
+    {
+        drop(cl);
+        return;
+    }
+    if (cmd == "NEW")
+    {
+        int rows = m_opts.rows;
+        int cols = m_opts.cols;
+        int n = m_opts.cyborgs;
+        string rest;
+        getline(iss >> ws, rest);
+        bool ok = rest.empty();
+        if (!ok)
+        {
+            istringstream args(rest);
+            ok = (args >> rows >> cols >> n) && (args >> ws).eof();
+        }
+        if (cl.session != -1)
+            send(cl, "ERR already in a session\n");
+        else if (!ok)
+            send(cl, "ERR usage: NEW [rows cols cyborgs]\n");
+        else if (rows < 1 || rows > MAXROWS || cols < 1 || cols > MAXCOLS
+                 || n < 0 || n > MAXCYBORGS || rows * cols - n - 1 < 0)
+            send(cl, "ERR bad arena size\n");
+        else
+        {
+            int id = m_host.open(rows, cols, n, m_opts.seed + m_nextSeed++, m_opts.channels);
+            m_sessions[id] = SessionEntry();
+            join(cl, id);
+        }
+        return;
+    }
+    if (cmd == "STATS")
+    {
+        string reply = "STATS " + to_string(m_host.sessionCount()) + ' '
+            + to_string(m_host.totalMemory());
+        if (cl.session != -1)
+            reply += ' ' + to_string(m_host.memoryUsed(cl.session));
+        send(cl, reply + '\n');
+        return;
+    }
+    if (cmd == "JOIN")
+    {
+        int id;
+        if (cl.session != -1)
+            send(cl, "ERR already in a session\n");
+        else if (!(iss >> id) || m_sessions.find(id) == m_sessions.end())
+            send(cl, "ERR no such session\n");
+        else
+            join(cl, id);
+        return;
+    }
+
+    if (cl.session == -1)
+    {
+        send(cl, "ERR not in a session\n");
+        return;
+    }
+    string arg;
+    iss >> arg;
+    int dir = arg.size() == 1 ? decodeDirection(static_cast<char>(tolower(arg[0]))) : BADDIR;
+    Session& s = *m_host.find(cl.session);
+    if ((cmd == "M" || cmd == "B") && s.isOver())
+    {
+        // Nothing steps a finished session, so a command would never drain
+        send(cl, "ERR game over\n");
+        return;
+    }
+    if (cmd == "M" && cl.channel == 0)
+    {
+        if (dir == BADDIR && arg != "x" && arg != "X")
+            send(cl, "ERR direction must be n, e, s, w or x\n");
+        else
+        {
+            s.submitPlayerMove(dir);
+            m_dirty.insert(cl.session);
+        }
+    }
+    else if (cmd == "B" && cl.channel != 0)
+    {
+        if (dir == BADDIR)
+            send(cl, "ERR direction must be n, e, s or w\n");
+        else
+        {
+            s.submitBroadcast(cl.member, cl.channel, dir);
+            m_dirty.insert(cl.session);
+        }
+    }
+    else
+        send(cl, "ERR unknown command for your role\n");
+}
+
+void Server::join(Client& cl, int id)
+{
+    // A member before anything is sent, so that a client dropped by a
+    // failed send is taken out of the session like any other
+    SessionEntry& e = m_sessions[id];
+    cl.session = id;
+    cl.member = e.nextMember++;
+    e.members.push_back(cl.fd);
+    string reply = "OK " + to_string(id);
+    if (!e.hasController)
+    {
+        e.hasController = true;
+        cl.channel = 0;
+        reply += " PLAYER\n";
+    }
+    else
+    {
+        cl.channel = e.nextChannel;
+        e.nextChannel = e.nextChannel % m_opts.channels + 1;
+        reply += " CHANNEL " + to_string(cl.channel) + "\n";
+    }
+    m_host.find(id)->snapshot(reply);
+    send(cl, reply);
+}
+
+void Server::tick()
+{
+    // Sends only mark clients dropped, so sessions and their member lists
+    // stay put until reap()
+    string out;
+    for (int id : m_dirty)
+    {
+        auto it = m_sessions.find(id);
+        if (it == m_sessions.end())
+            continue;
+        out.clear();
+        if (!m_host.find(id)->step(out))
+            continue;
+        for (int fd : it->second.members)
+        {
+            auto c = m_clients.find(fd);
+            if (c != m_clients.end())
+                send(c->second, out);
+        }
+    }
+    m_dirty.clear();
+}
+
+void Server::send(Client& cl, const string& s)
+{
+    if (cl.dropped)
+        return;
+    cl.out += s;
+    flush(cl);
+}
+
+void Server::flush(Client& cl)
+{
+    while (!cl.out.empty())
+    {
+        ssize_t n = write(cl.fd, cl.out.data(), cl.out.size());
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                drop(cl);
+                return;
+            }
+            break;
+        }
+        cl.out.erase(0, static_cast<size_t>(n));
+    }
+    if (cl.out.size() > MAX_PENDING_OUT)
+    {
+        drop(cl);
+        return;
+    }
+    bool want = !cl.out.empty();
+    if (want != cl.watchingOut)
+    {
+        cl.watchingOut = want;
+        watch(cl.fd, EPOLLIN | (want ? EPOLLOUT : 0u), EPOLL_CTL_MOD);
+    }
+}
+
+void Server::drop(Client& cl)
+{
+    if (cl.dropped)
+        return;
+    cl.dropped = true;
+    m_dropped.push_back(cl.fd);
+}
+
+void Server::reap()
+{
+    for (size_t i = 0; i < m_dropped.size(); i++)
+        close(m_dropped[i]);
+    m_dropped.clear();
+}
+
+void Server::close(int fd)
+{
+    auto it = m_clients.find(fd);
+    if (it == m_clients.end())
+        return;
+    int id = it->second.session;
+    bool wasController = it->second.channel == 0;
+    m_clients.erase(it);
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+
+    auto s = m_sessions.find(id);
+    if (s == m_sessions.end())
+        return;
+    vector<int>& members = s->second.members;
+    for (size_t i = 0; i < members.size(); i++)
+        if (members[i] == fd)
+        {
+            members.erase(members.begin() + i);
+            break;
+        }
+    if (wasController)
+        s->second.hasController = false;  // next joiner takes the player
+    if (members.empty())
+    {
+        m_sessions.erase(s);
+        m_dirty.erase(id);
+        m_host.close(id);
+    }
+}
+
+void usage()
+{
+    cerr << "usage: cyborgs_server [--unix PATH | --port N] [--hz N] [--seed N]\n"
+            "                      [--rows R] [--cols C] [--cyborgs N] [--channels N]" << endl;
+    exit(2);
+}
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////
+// main()
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+    Options opts;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (i + 1 >= argc)
+            usage();
+        string val = argv[++i];
+        if (arg == "--unix")
+            opts.unixPath = val;
+        else if (arg == "--port")
+            opts.port = atoi(val.c_str());
+        else if (arg == "--hz")
+            opts.hz = atoi(val.c_str());
+        else if (arg == "--seed")
+            opts.seed = static_cast<unsigned int>(strtoul(val.c_str(), nullptr, 10));
+        else if (arg == "--rows")
+            opts.rows = atoi(val.c_str());
+        else if (arg == "--cols")
+            opts.cols = atoi(val.c_str());
+        else if (arg == "--cyborgs")
+            opts.cyborgs = atoi(val.c_str());
+        else if (arg == "--channels")
+            opts.channels = atoi(val.c_str());
+        else
+            usage();
+    }
+    if ((opts.unixPath.empty() && opts.port <= 0) || opts.hz <= 0
+        || opts.channels < 1 || opts.channels > CHANNEL_LIMIT)
+        usage();
+
+    Server server(opts);
+    return server.run();
+}
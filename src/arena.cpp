@@ -0,0 +1,610 @@
+// arena.cpp
+
+#include "cyborgs/arena.h"
+#include "cyborgs/rng.h"
+#include "cyborgs/rules.h"
+
+#include <algorithm>
+#include <iostream>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <cstdlib>
+using namespace std;
+
+namespace cyborgs
+{
+
+// Arena never runs destructors for the objects it keeps in its block
+static_assert(is_trivially_destructible<Cyborg>::value, "Cyborg must be trivially destructible");
+static_assert(is_trivially_destructible<Player>::value, "Player must be trivially destructible");
+
+namespace
+{
+    // Row and column step for each direction, indexed by NORTH..WEST
+    const int ROW_STEP[NUMDIRS] = { -1, 0, 1, 0 };
+    const int COL_STEP[NUMDIRS] = { 0, 1, 0, -1 };
+
+    // The same for each history step code's direction, STEP_STAY included
+    const int CODE_ROW_STEP[STEP_STAY + 1] = { -1, 0, 1, 0, 0 };
+    const int CODE_COL_STEP[STEP_STAY + 1] = { 0, 1, 0, -1, 0 };
+}
+
+///////////////////////////////////////////////////////////////////////////
+//  Cyborg implementation
+///////////////////////////////////////////////////////////////////////////
+
+Cyborg::Cyborg(Arena* ap, int r, int c, int channel)
+{
+    if (ap == nullptr)
+    {
+        cout << "***** A cyborg must be created in some Arena!" << endl;
+        exit(1);
+    }
+    if (r < 1 || r > ap->rows() || c < 1 || c > ap->cols())
+    {
+        cout << "***** Cyborg created with invalid coordinates (" << r << ","
+            << c << ")!" << endl;
+        exit(1);
+    }
+    if (channel < 1 || channel > ap->channels())
+    {
+        cout << "***** Cyborg created with invalid channel " << channel << endl;
+        exit(1);
+    }
+    m_arena = ap;
+    m_row = r;
+    m_col = c;
+    m_channel = channel;
+    m_health = INITIAL_CYBORG_HEALTH;
+}
+
+void Cyborg::forceMove(int dir)
+{
+    if (dir < 0 || dir >= NUMDIRS)
+        return;
+    if (m_arena->topology().moves(m_row, m_col) & (1 << dir))
+    {
+        m_row += ROW_STEP[dir];
+        m_col += COL_STEP[dir];
+    }
+    else
+        m_health--;
+}
+
+void Cyborg::move()
+{
+    if (!isDead())
+        attemptMove(*m_arena, randInt(0, NUMDIRS - 1), m_row, m_col);
+}
+
+///////////////////////////////////////////////////////////////////////////
+//  Player implementation
+///////////////////////////////////////////////////////////////////////////
+
+Player::Player(Arena* ap, int r, int c)
+{
+    if (ap == nullptr)
+    {
+        cout << "***** The player must be created in some Arena!" << endl;
+        exit(1);
+    }
+    if (r < 1 || r > ap->rows() || c < 1 || c > ap->cols())
+    {
+        cout << "**** Player created with invalid coordinates (" << r
+            << "," << c << ")!" << endl;
+        exit(1);
+    }
+    m_arena = ap;
+    m_row = r;
+    m_col = c;
+    m_dead = false;
+}
+
+string Player::stand()
+{
+    return "Player stands.";
+}
+
+string Player::move(int dir)
+{
+    static const char* const DIR_NAME[NUMDIRS] = { "north", "east", "south", "west" };
+    if (dir < 0 || dir >= NUMDIRS)
+        return "0";
+    if ((m_arena->topology().moves(m_row, m_col) & (1 << dir)) == 0)
+        return "Player couldn't move; player stands.";
+    m_row += ROW_STEP[dir];
+    m_col += COL_STEP[dir];
+    if (m_arena->numberOfCyborgsAt(m_row, m_col) == 0)
+        return string("Player moved ") + DIR_NAME[dir] + ".";
+    setDead();
+    return "Player walked into a cybord and died.";
+}
+
+void Player::setDead()
+{
+    m_dead = true;
+}
+
+///////////////////////////////////////////////////////////////////////////
+//  Arena implementation
+///////////////////////////////////////////////////////////////////////////
+
+Arena::Arena(int nRows, int nCols, int nChannels, int maxCyborgs)
+{
+    reset(nRows, nCols, nChannels, maxCyborgs);
+}
+
+Arena::~Arena()
+{
+    // Cyborg and Player are trivially destructible; m_memory frees them
+}
+
+void Arena::reset(int nRows, int nCols, int nChannels, int maxCyborgs)
+{
+    if (nRows <= 0 || nCols <= 0 || nRows > ARENA_MAXDIM || nCols > ARENA_MAXDIM)
+    {
+        cout << "***** Arena created with invalid size " << nRows << " by "
+            << nCols << "!" << endl;
+        exit(1);
+    }
+    if (nChannels < 1 || nChannels > CHANNEL_LIMIT)
+    {
+        cout << "***** Arena created with invalid number of channels "
+            << nChannels << "!" << endl;
+        exit(1);
+    }
+    if (maxCyborgs < 0)
+    {
+        cout << "***** Arena created with room for " << maxCyborgs
+            << " cyborgs!" << endl;
+        exit(1);
+    }
+    size_t nCells = static_cast<size_t>(nRows) * nCols;
+    m_memory.reset(nCells * sizeof(bool)
+        + static_cast<size_t>(maxCyborgs) * sizeof(Cyborg) + alignof(Cyborg)
+        + (nChannels + 2) * sizeof(int) + alignof(int)
+        + sizeof(Player) + alignof(Player));
+    m_wallGrid = m_memory.allocateArray<bool>(nCells);
+    m_cyborgs = m_memory.allocateArray<Cyborg>(maxCyborgs);
+    m_channelStart = m_memory.allocateArray<int>(nChannels + 2);
+    m_rows = nRows;
+    m_cols = nCols;
+    m_nChannels = nChannels;
+    m_player = nullptr;
+    m_nCyborgs = 0;
+    m_maxCyborgs = maxCyborgs;
+    for (size_t i = 0; i < nCells; i++)
+        m_wallGrid[i] = false;
+    for (int ch = 0; ch <= nChannels + 1; ch++)
+        m_channelStart[ch] = 0;
+    m_topologyCurrent = false;
+    m_history.reset();
+}
+
+void Arena::copyFrom(const Arena& other)
+{
+    if (&other == this)
+        return;
+    reset(other.m_rows, other.m_cols, other.m_nChannels, other.m_maxCyborgs);
+    size_t nCells = static_cast<size_t>(m_rows) * m_cols;
+    for (size_t i = 0; i < nCells; i++)
+        m_wallGrid[i] = other.m_wallGrid[i];
+    for (int i = 0; i < other.m_nCyborgs; i++)
+    {
+        new (&m_cyborgs[i]) Cyborg(other.m_cyborgs[i]);
+        m_cyborgs[i].m_arena = this;
+    }
+    for (int ch = 0; ch <= m_nChannels + 1; ch++)
+        m_channelStart[ch] = other.m_channelStart[ch];
+    m_nCyborgs = other.m_nCyborgs;
+    if (other.m_topologyCurrent)
+    {
+        m_topology = other.m_topology;  // unchanged while shared
+        m_topologyCurrent = true;
+    }
+    if (other.m_player != nullptr)
+    {
+        // Not addPlayer: a dead player may share its cell with a cyborg
+        m_player = new (m_memory.allocate(sizeof(Player), alignof(Player)))
+            Player(this, other.m_player->row(), other.m_player->col());
+        if (other.m_player->isDead())
+            m_player->setDead();
+    }
+}
+
+void Arena::sortCyborgs()
+{
+    // Cyborgs placed at random touch the move masks at random; in cell
+    // order a walk or a broadcast sweeps them front to back.  Cyborgs move
+    // one step a turn, so the order stays close to sorted for a long time.
+    for (int ch = 1; ch <= m_nChannels; ch++)
+        sort(m_cyborgs + m_channelStart[ch], m_cyborgs + m_channelStart[ch + 1],
+            [](const Cyborg& x, const Cyborg& y) {
+                return x.m_row < y.m_row || (x.m_row == y.m_row && x.m_col < y.m_col);
+            });
+    forgetHistory();  // deltas name cyborgs by index
+}
+
+void Arena::enableHistory(int maxTurns, int keyframeInterval)
+{
+    if (maxTurns <= 0)
+        m_history.reset();
+    else
+        m_history.reset(new TurnHistory(maxTurns, keyframeInterval));
+}
+
+void Arena::beginTurn()
+{
+    if (m_history)
+        m_history->beginTurn(playerRecord());
+}
+
+bool Arena::undoTurn()
+{
+    return m_history && seekTurn(m_history->turn() - 1);
+}
+
+bool Arena::redoTurn()
+{
+    return m_history && seekTurn(m_history->turn() + 1);
+}
+
+bool Arena::seekTurn(long long turn)
+{
+    if (!m_history || turn < m_history->oldestTurn() || turn > m_history->newestTurn())
+        return false;
+
+    // Replaying costs a delta a turn.  Restoring a keyframe costs about as
+    // much as one, and then the turns after it are replayed.
+    long long now = m_history->turn();
+    long long replay = (now > turn ? now - turn : turn - now);
+    long long k = m_history->keyframeBefore(turn);
+    if (k >= 0 && 1 + (turn - k) < replay)
+    {
+        restoreKeyframe(m_history->delta(k));
+        now = k;
+    }
+    for (; now < turn; now++)
+        redoDelta(m_history->delta(now));
+    for (; now > turn; now--)
+        undoDelta(m_history->delta(now - 1));
+    m_history->setTurn(turn);
+    return true;
+}
+
+size_t Arena::memoryUsed() const
+{
+    // A topology shared with copies is counted by none of them, rather
+    // than by each
+    size_t total = sizeof(Arena) + m_memory.capacity();
+    if (m_topology && m_topology.use_count() == 1)
+        total += m_topology->memoryUsed();
+    if (m_history)
+        total += m_history->memoryUsed();
+    return total;
+}
+
+int Arena::numberOfCyborgsAt(int r, int c) const
+{
+    int num = 0;
+    for (size_t i = 0; i < m_nCyborgs; i++)
+    {
+        if (m_cyborgs[i].row() == r && m_cyborgs[i].col() == c)
+            num++;
+    }
+    return num;
+}
+
+void Arena::placeWallAt(int r, int c)
+{
+    checkPos(r, c, "Arena::placeWallAt");
+    m_wallGrid[(r - 1) * m_cols + (c - 1)] = true;
+    m_topologyCurrent = false;
+    forgetHistory();
+}
+
+void Arena::buildTopology(int nThreads)
+{
+    updateTopology(nThreads);
+}
+
+void Arena::updateTopology(int nThreads) const
+{
+    // A copy, a CohortArena or another thread may still be reading a
+    // shared topology, so only one this arena alone holds is rebuilt
+    if (m_topology && m_topology.use_count() == 1)
+        m_topology->rebuild(m_wallGrid, m_rows, m_cols, nThreads);
+    else
+        m_topology = make_shared<WallTopology>(m_wallGrid, m_rows, m_cols, nThreads);
+    m_topologyCurrent = true;
+}
+
+bool Arena::addCyborg(int r, int c, int channel)
+{
+    if (!isPosInBounds(r, c) || hasWallAt(r, c))
+        return false;
+    if (m_player != nullptr && m_player->row() == r && m_player->col() == c)
+        return false;
+    if (channel < 1 || channel > m_nChannels)
+        return false;
+    if (m_nCyborgs == m_maxCyborgs)
+        return false;
+
+    // Open a slot at the end of the channel's range by moving the first
+    // cyborg of each later channel to just past that channel's end
+    for (int ch = m_nChannels; ch > channel; ch--)
+        if (m_channelStart[ch] < m_channelStart[ch + 1])
+            new (&m_cyborgs[m_channelStart[ch + 1]]) Cyborg(m_cyborgs[m_channelStart[ch]]);
+    new (&m_cyborgs[m_channelStart[channel + 1]]) Cyborg(this, r, c, channel);
+    for (int ch = channel + 1; ch <= m_nChannels + 1; ch++)
+        m_channelStart[ch]++;
+    m_nCyborgs++;
+    forgetHistory();
+    return true;
+}
+
+bool Arena::addPlayer(int r, int c)
+{
+    if (m_player != nullptr || !isPosInBounds(r, c) || hasWallAt(r, c))
+        return false;
+    if (numberOfCyborgsAt(r, c) > 0)
+        return false;
+    m_player = new (m_memory.allocate(sizeof(Player), alignof(Player))) Player(this, r, c);
+    forgetHistory();
+    return true;
+}
+
+string Arena::moveCyborgs(int channel, int dir)
+{
+    // Cyborgs on the channel will respond with probability 1/2
+    bool willRespond = (randInt(0, 1) == 0);
+
+    // Record the turn as the kernels play it, if there is a history
+    TurnDelta* delta = nullptr;
+    unsigned char* steps = nullptr;
+    vector<CyborgRecord>* removed = nullptr;
+    if (m_history)
+    {
+        delta = &m_history->recordTurn(playerRecord());
+        if (delta->keyframe)
+        {
+            for (int i = 0; i < m_nCyborgs; i++)
+                delta->snapshot.push_back({ i, m_cyborgs[i].m_row, m_cyborgs[i].m_col,
+                    m_cyborgs[i].m_health });
+            delta->channelStart.assign(m_channelStart, m_channelStart + m_nChannels + 2);
+        }
+        delta->steps.assign(m_nCyborgs, STEP_STAY);
+        steps = delta->steps.data();
+        removed = &delta->removed;
+    }
+
+    // Move all cyborgs
+    int nCyborgsOriginally = m_nCyborgs;
+
+    if (willRespond && channel >= 1 && channel <= m_nChannels)
+    {
+        // A bad direction leaves the channel standing, as forceMove does
+        walkCyborgs(0, m_channelStart[channel], steps);
+        if (dir >= 0 && dir < NUMDIRS)
+            pushCyborgs(m_channelStart[channel], m_channelStart[channel + 1], dir, steps);
+        walkCyborgs(m_channelStart[channel + 1], m_nCyborgs, steps);
+
+        // Only a broadcast can destroy cyborgs, and only on its channel
+        removeDead(channel, removed);
+        if (delta != nullptr)
+            delta->channel = channel;
+    }
+    else
+        walkCyborgs(0, m_nCyborgs, steps);
+
+    if (m_player != nullptr)
+    {
+        int pr = m_player->row();
+        int pc = m_player->col();
+        bool caught = false;
+        for (int i = 0; i < m_nCyborgs; i++)
+            caught |= (m_cyborgs[i].m_row == pr) & (m_cyborgs[i].m_col == pc);
+        if (caught)
+            m_player->setDead();
+    }
+    if (delta != nullptr)
+        delta->playerAfter = playerRecord();
+
+    if (m_nCyborgs < nCyborgsOriginally)
+        return "Some cyborgs have been destroyed.";
+    else
+        return "No cyborgs were destroyed.";
+}
+
+void Arena::pushCyborgs(int begin, int end, int dir, unsigned char* steps)
+{
+    const unsigned char* moves = topology().moveMasks();
+    int dr = ROW_STEP[dir];
+    int dc = COL_STEP[dir];
+    for (int i = begin; i < end; i++)
+    {
+        Cyborg& cy = m_cyborgs[i];
+        int open = (moves[(cy.m_row - 1) * m_cols + (cy.m_col - 1)] >> dir) & 1;
+        cy.m_row += open * dr;
+        cy.m_col += open * dc;
+        cy.m_health -= 1 - open;
+        if (steps != nullptr)
+            steps[i] = static_cast<unsigned char>(open ? dir : STEP_STAY | STEP_HURT);
+    }
+}
+
+void Arena::walkCyborgs(int begin, int end, unsigned char* steps)
+{
+    const unsigned char* moves = topology().moveMasks();
+    for (int i = begin; i < end; i++)
+    {
+        Cyborg& cy = m_cyborgs[i];
+        int dir = randInt(0, NUMDIRS - 1);
+        int dr = ROW_STEP[dir];
+        int dc = COL_STEP[dir];
+        int open = (moves[(cy.m_row - 1) * m_cols + (cy.m_col - 1)] >> dir) & 1;
+        cy.m_row += open * dr;
+        cy.m_col += open * dc;
+        if (steps != nullptr)
+            steps[i] = static_cast<unsigned char>(open ? dir : STEP_STAY);
+    }
+}
+
+int Arena::removeDead(int channel, vector<CyborgRecord>* removed)
+{
+    int begin = m_channelStart[channel];
+    int end = m_channelStart[channel + 1];
+    if (removed != nullptr)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            const Cyborg& cy = m_cyborgs[i];
+            if (cy.isDead())
+                removed->push_back({ i, cy.m_row, cy.m_col, cy.m_health });
+        }
+    }
+
+    // Compact the channel's survivors to the front of its range
+    int kept = begin;
+    for (int i = begin; i < end; i++)
+    {
+        m_cyborgs[kept] = m_cyborgs[i];
+        kept += !m_cyborgs[i].isDead();
+    }
+    int nDead = end - kept;
+    if (nDead == 0)
+        return 0;
+
+    // Slide every later channel down over the gap, moving at most nDead
+    // cyborgs from the end of each range into the space before it
+    for (int ch = channel + 1; ch <= m_nChannels; ch++)
+    {
+        int size = m_channelStart[ch + 1] - m_channelStart[ch];
+        int n = (size < nDead ? size : nDead);
+        int from = m_channelStart[ch + 1] - n;
+        int to = m_channelStart[ch] - nDead;
+        for (int k = 0; k < n; k++)
+            m_cyborgs[to + k] = m_cyborgs[from + k];
+    }
+    for (int ch = channel + 1; ch <= m_nChannels + 1; ch++)
+        m_channelStart[ch] -= nDead;
+    m_nCyborgs -= nDead;
+    return nDead;
+}
+
+void Arena::undoDelta(const TurnDelta& d)
+{
+    if (d.channel != 0)
+        restoreDead(d.channel, d.removed);
+    const unsigned char* steps = d.steps.data();
+    int n = static_cast<int>(d.steps.size());
+    for (int i = 0; i < n; i++)
+    {
+        Cyborg& cy = m_cyborgs[i];
+        int code = steps[i];
+        cy.m_row -= CODE_ROW_STEP[code & STEP_DIR];
+        cy.m_col -= CODE_COL_STEP[code & STEP_DIR];
+        cy.m_health += (code & STEP_HURT) / STEP_HURT;
+    }
+    restorePlayer(d.playerBefore);
+}
+
+void Arena::redoDelta(const TurnDelta& d)
+{
+    const unsigned char* steps = d.steps.data();
+    int n = static_cast<int>(d.steps.size());
+    for (int i = 0; i < n; i++)
+    {
+        Cyborg& cy = m_cyborgs[i];
+        int code = steps[i];
+        cy.m_row += CODE_ROW_STEP[code & STEP_DIR];
+        cy.m_col += CODE_COL_STEP[code & STEP_DIR];
+        cy.m_health -= (code & STEP_HURT) / STEP_HURT;
+    }
+    if (d.channel != 0)
+        removeDead(d.channel, nullptr);  // the same cyborgs die again
+    restorePlayer(d.playerAfter);
+}
+
+void Arena::restoreDead(int channel, const vector<CyborgRecord>& removed)
+{
+    int nDead = static_cast<int>(removed.size());
+    if (nDead == 0)
+        return;
+
+    // Undo removeDead's slide, last channel first: each later channel's
+    // first n cyborgs go back to the end of its old range
+    for (int ch = m_nChannels; ch > channel; ch--)
+    {
+        int size = m_channelStart[ch + 1] - m_channelStart[ch];
+        int n = (size < nDead ? size : nDead);
+        int from = m_channelStart[ch];
+        int to = m_channelStart[ch + 1] + nDead - n;
+        for (int k = 0; k < n; k++)
+            m_cyborgs[to + k] = m_cyborgs[from + k];
+    }
+    for (int ch = channel + 1; ch <= m_nChannels + 1; ch++)
+        m_channelStart[ch] += nDead;
+    m_nCyborgs += nDead;
+
+    // Spread the survivors back out from the end, putting the dead in the
+    // gaps; below the first of the dead, survivors never moved
+    int from = m_channelStart[channel + 1] - nDead - 1;
+    int k = nDead - 1;
+    for (int i = m_channelStart[channel + 1] - 1; k >= 0; i--)
+    {
+        if (removed[k].index == i)
+            restoreCyborg(i, removed[k--], channel);
+        else
+            m_cyborgs[i] = m_cyborgs[from--];
+    }
+}
+
+void Arena::restoreCyborg(int i, const CyborgRecord& r, int channel)
+{
+    new (&m_cyborgs[i]) Cyborg(this, r.row, r.col, channel);
+    m_cyborgs[i].m_health = r.health;
+}
+
+void Arena::restoreKeyframe(const TurnDelta& d)
+{
+    for (int ch = 0; ch <= m_nChannels + 1; ch++)
+        m_channelStart[ch] = d.channelStart[ch];
+    m_nCyborgs = static_cast<int>(d.snapshot.size());
+    for (int ch = 1; ch <= m_nChannels; ch++)
+        for (int i = m_channelStart[ch]; i < m_channelStart[ch + 1]; i++)
+            restoreCyborg(i, d.snapshot[i], ch);
+    restorePlayer(d.playerBefore);
+}
+
+PlayerRecord Arena::playerRecord() const
+{
+    if (m_player == nullptr)
+        return { 0, 0, false };
+    return { m_player->m_row, m_player->m_col, m_player->m_dead };
+}
+
+void Arena::restorePlayer(const PlayerRecord& p)
+{
+    if (m_player == nullptr)
+        return;
+    m_player->m_row = p.row;
+    m_player->m_col = p.col;
+    m_player->m_dead = p.dead;
+}
+
+void Arena::forgetHistory()
+{
+    if (m_history)
+        m_history->clear();
+}
+
+void Arena::reportBadPos(int r, int c, const char* functionName) const
+{
+    cout << "***** " << "Invalid arena position (" << r << ","
+        << c << ") in call to " << functionName << endl;
+    exit(1);
+}
+
+}  // namespace cyborgs
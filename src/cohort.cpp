@@ -0,0 +1,202 @@
+// cohort.cpp
+
+#include "cyborgs/cohort.h"
+#include "cyborgs/arena.h"
+#include "cyborgs/constants.h"
+#include "cyborgs/rng.h"
+
+#include <random>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace cyborgs
+{
+
+namespace
+{
+    // Below this size, rolling each cyborg is cheaper than sampling binomials
+    const long long SMALL_COHORT = 16;
+}
+
+///////////////////////////////////////////////////////////////////////////
+//  CohortArena implementation
+///////////////////////////////////////////////////////////////////////////
+
+CohortArena::CohortArena(const Arena& a)
+{
+    m_rows = a.rows();
+    m_cols = a.cols();
+    m_channels = a.channels();
+    m_topology = a.sharedTopology();
+    const Player* p = a.player();
+    m_playerCell = (p == nullptr ? -1 : (p->row() - 1) * m_cols + (p->col() - 1));
+    m_playerDead = (p != nullptr && p->isDead());
+    m_nCyborgs = 0;
+    m_slot.resize(static_cast<size_t>(m_rows) * m_cols * m_channels * INITIAL_CYBORG_HEALTH);
+    m_stamp.assign(m_slot.size(), 0);
+    m_gen = 1;
+    for (int i = 0; i < a.cyborgCount(); i++)
+    {
+        const Cyborg& cy = a.cyborg(i);
+        emit((cy.row() - 1) * m_cols + (cy.col() - 1), cy.channel(), cy.health(), 1);
+        m_nCyborgs++;
+    }
+    m_cohorts.swap(m_next);
+}
+
+int CohortArena::rows() const
+{
+    return m_rows;
+}
+
+int CohortArena::cols() const
+{
+    return m_cols;
+}
+
+long long CohortArena::cyborgCount() const
+{
+    return m_nCyborgs;
+}
+
+long long CohortArena::numberOfCyborgsAt(int r, int c) const
+{
+    int cell = (r - 1) * m_cols + (c - 1);
+    long long num = 0;
+    for (size_t i = 0; i < m_cohorts.size(); i++)
+        if (m_cohorts[i].cell == cell)
+            num += m_cohorts[i].count;
+    return num;
+}
+
+int CohortArena::cohortCount() const
+{
+    return static_cast<int>(m_cohorts.size());
+}
+
+bool CohortArena::isPlayerDead() const
+{
+    return m_playerDead;
+}
+
+bool CohortArena::hasWallAt(int r, int c) const
+{
+    return m_topology->region(r, c) == 0;
+}
+
+bool CohortArena::addCyborgs(int r, int c, int channel, long long count)
+{
+    if (r < 1 || r > m_rows || c < 1 || c > m_cols || hasWallAt(r, c))
+        return false;
+    int cell = (r - 1) * m_cols + (c - 1);
+    if (cell == m_playerCell || channel < 1 || channel > m_channels || count <= 0)
+        return false;
+
+    // emit() builds into m_next, while m_slot currently indexes m_cohorts
+    m_next.swap(m_cohorts);
+    emit(cell, channel, INITIAL_CYBORG_HEALTH, count);
+    m_next.swap(m_cohorts);
+    m_nCyborgs += count;
+    return true;
+}
+
+string CohortArena::moveCyborgs(int channel, int dir)
+{
+    // Cyborgs on the channel will respond with probability 1/2
+    bool willRespond = (randInt(0, 1) == 0);
+
+    long long nCyborgsOriginally = m_nCyborgs;
+    beginTurn();
+    for (size_t i = 0; i < m_cohorts.size(); i++)
+    {
+        const Cohort& k = m_cohorts[i];
+        if (willRespond && k.channel == channel)
+        {
+            // The whole cohort hits the wall together or moves together
+            int to = neighbor(k.cell, dir);
+            if (to >= 0)
+                emit(to, k.channel, k.health, k.count);
+            else if (k.health > 1)
+                emit(k.cell, k.channel, k.health - 1, k.count);
+            else
+                m_nCyborgs -= k.count;
+            continue;
+        }
+
+        // Each cyborg picks one of NUMDIRS directions uniformly.  Small
+        // cohorts roll per cyborg; large ones draw the multinomial split as
+        // a chain of binomials.
+        long long split[NUMDIRS] = { 0, 0, 0, 0 };
+        if (k.count <= SMALL_COHORT)
+        {
+            for (long long n = 0; n < k.count; n++)
+                split[randInt(0, NUMDIRS - 1)]++;
+        }
+        else
+        {
+            long long left = k.count;
+            for (int d = 0; d < NUMDIRS - 1 && left > 0; d++)
+            {
+                binomial_distribution<long long> pick(left, 1.0 / (NUMDIRS - d));
+                split[d] = pick(randomEngine());
+                left -= split[d];
+            }
+            split[NUMDIRS - 1] = left;
+        }
+        for (int d = 0; d < NUMDIRS; d++)
+        {
+            if (split[d] == 0)
+                continue;
+            int to = neighbor(k.cell, d);
+            emit(to >= 0 ? to : k.cell, k.channel, k.health, split[d]);
+        }
+    }
+    m_cohorts.swap(m_next);
+
+    for (size_t i = 0; i < m_cohorts.size(); i++)
+        if (m_cohorts[i].cell == m_playerCell)
+            m_playerDead = true;
+
+    if (m_nCyborgs < nCyborgsOriginally)
+        return "Some cyborgs have been destroyed.";
+    else
+        return "No cyborgs were destroyed.";
+}
+
+int CohortArena::neighbor(int cell, int dir) const
+{
+    if (dir < 0 || dir >= NUMDIRS)
+        return cell;
+    if (((m_topology->moveMasks()[cell] >> dir) & 1) == 0)
+        return -1;
+    const int step[NUMDIRS] = { -m_cols, 1, m_cols, -1 };
+    return cell + step[dir];
+}
+
+void CohortArena::beginTurn()
+{
+    m_next.clear();
+    m_gen++;
+    if (m_gen == 0)  // wrapped: stale stamps could look current
+    {
+        m_stamp.assign(m_stamp.size(), 0);
+        m_gen = 1;
+    }
+}
+
+void CohortArena::emit(int cell, int channel, int health, long long count)
+{
+    size_t key = (static_cast<size_t>(cell) * m_channels + (channel - 1))
+        * INITIAL_CYBORG_HEALTH + (health - 1);
+    if (m_stamp[key] == m_gen)
+        m_next[m_slot[key]].count += count;
+    else
+    {
+        m_stamp[key] = m_gen;
+        m_slot[key] = static_cast<int>(m_next.size());
+        m_next.push_back({ cell, channel, health, count });
+    }
+}
+
+}  // namespace cyborgs
@@ -0,0 +1,105 @@
+// frames.cpp
+
+#include "cyborgs/frames.h"
+#include "cyborgs/render.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <cstdlib>
+using namespace std;
+
+namespace cyborgs
+{
+
+///////////////////////////////////////////////////////////////////////////
+//  FrameBuffer implementation
+///////////////////////////////////////////////////////////////////////////
+
+FrameBuffer::FrameBuffer()
+    : m_back(0), m_front(1), m_middle(2), m_published(0)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        m_frames[i].turn = 0;
+        m_frames[i].game = 0;
+        m_frames[i].cyborgs = 0;
+        m_frames[i].playerDead = false;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+//  RenderThread implementation
+///////////////////////////////////////////////////////////////////////////
+
+RenderThread::RenderThread(FrameBuffer& frames, ostream& out, double maxFps)
+    : m_frames(frames), m_out(out), m_maxFps(maxFps), m_running(false), m_drawn(0)
+{
+    if (!(maxFps > 0))
+    {
+        cout << "***** Render thread at up to " << maxFps << " fps!" << endl;
+        exit(1);
+    }
+}
+
+RenderThread::~RenderThread()
+{
+    stop();
+}
+
+long long RenderThread::framesDrawn() const
+{
+    return m_drawn;
+}
+
+void RenderThread::start()
+{
+    if (m_running)
+        return;
+    m_running = true;
+    m_thread = thread(&RenderThread::run, this);
+}
+
+void RenderThread::stop()
+{
+    if (!m_running)
+        return;
+    m_running = false;
+    m_thread.join();
+    if (m_frames.acquire())
+        draw(m_frames.front());
+}
+
+void RenderThread::run()
+{
+    chrono::steady_clock::duration period = chrono::duration_cast<chrono::steady_clock::duration>(
+        chrono::duration<double>(1 / m_maxFps));
+    chrono::steady_clock::time_point next = chrono::steady_clock::now();
+    while (m_running)
+    {
+        if (m_frames.acquire())
+            draw(m_frames.front());
+
+        // Sleep to the next frame slot; if drawing overran it, start the
+        // schedule again from now rather than drawing back to back
+        next += period;
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        if (next < now)
+            next = now + period;
+        this_thread::sleep_until(next);
+    }
+}
+
+void RenderThread::draw(const Frame& f)
+{
+    if (&m_out == &cout)
+        clearScreen();
+    m_out << f.grid << '\n'
+        << "Game " << f.game << ", turn " << f.turn << ": " << f.cyborgs
+        << " cyborgs remaining" << (f.playerDead ? "; the player is dead." : ".") << '\n'
+        << flush;
+    m_drawn++;
+}
+
+}  // namespace cyborgs
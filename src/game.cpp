@@ -0,0 +1,230 @@
+// game.cpp
+
+#include "cyborgs/game.h"
+#include "cyborgs/arena.h"
+#include "cyborgs/planner.h"
+#include "cyborgs/render.h"
+#include "cyborgs/rng.h"
+#include "cyborgs/rules.h"
+
+#include <iostream>
+#include <string>
+#include <cctype>
+#include <cstdlib>
+#include <cassert>
+using namespace std;
+
+namespace cyborgs
+{
+
+///////////////////////////////////////////////////////////////////////////
+//  Game implementation
+///////////////////////////////////////////////////////////////////////////
+
+Game::Game(int rows, int cols, int nCyborgs, int nChannels)
+{
+    if (rows <= 0 || cols <= 0 || rows > MAXROWS || cols > MAXCOLS)
+    {
+        cout << "***** Game created with invalid size " << rows << " by "
+            << cols << "!" << endl;
+        exit(1);
+    }
+    if (nCyborgs < 0 || nCyborgs > MAXCYBORGS)
+    {
+        cout << "***** Game created with invalid number of cyborgs:  "
+            << nCyborgs << endl;
+        exit(1);
+    }
+    int nEmpty = rows * cols - nCyborgs - 1;  // 1 for Player
+    if (nEmpty < 0)
+    {
+        cout << "***** Game created with a " << rows << " by "
+            << cols << " arena, which is too small too hold a player and "
+            << nCyborgs << " cyborgs!" << endl;
+        exit(1);
+    }
+
+    // Create arena
+    m_arena = new Arena(rows, cols, nChannels);
+    m_inputClosed = false;
+    populateArena(*m_arena, nCyborgs);
+    m_arena->enableHistory(MAXUNDO);
+}
+
+Game::~Game()
+{
+    delete m_arena;
+}
+
+Arena& Game::arena() const
+{
+    return *m_arena;
+}
+
+string Game::takePlayerTurn()
+{
+    for (;;)
+    {
+        cout << "Your move (n/e/s/w/x, u/r to undo/redo, or nothing): ";
+        string playerMove;
+        if (!getline(cin, playerMove))
+        {
+            m_inputClosed = true;
+            return "";
+        }
+        m_arena->beginTurn();  // the turn's player move is next
+
+        Player* player = m_arena->player();
+        int dir;
+
+        if (playerMove.size() == 0)
+        {
+            if (recommendMove(*m_arena, player->row(), player->col(), dir))
+                return player->move(dir);
+            else
+                return player->stand();
+        }
+        else if (playerMove.size() == 1)
+        {
+            char ch = static_cast<char>(tolower(playerMove[0]));
+            if (ch == 'x')
+                return player->stand();
+            else if (ch == 'u' || ch == 'r')
+            {
+                if (ch == 'u' ? m_arena->undoTurn() : m_arena->redoTurn())
+                    m_arena->display(ch == 'u' ? "Turn undone." : "Turn redone.");
+                else
+                    cout << "There is no turn to " << (ch == 'u' ? "undo." : "redo.") << endl;
+                continue;
+            }
+            else
+            {
+                dir = decodeDirection(tolower(playerMove[0]));
+                if (dir != BADDIR)
+                    return player->move(dir);
+            }
+        }
+        cout << "Player move must be nothing, or 1 character n/e/s/w/x/u/r." << endl;
+    }
+}
+
+string Game::takeCyborgsTurn()
+{
+    for (;;)
+    {
+        cout << "Broadcast (e.g., 2n, or ? for advice): ";
+        string broadcast;
+        if (!getline(cin, broadcast))
+        {
+            m_inputClosed = true;
+            return "";
+        }
+        if (broadcast == "?")
+        {
+            Plan plan = planBroadcasts(*m_arena);
+            if (plan.steps.empty())
+                cout << "The planner has no advice." << endl;
+            else
+                cout << "Try " << channelSymbol(plan.steps[0].channel)
+                    << "nesw"[plan.steps[0].dir] << " (a " << plan.steps.size()
+                    << "-step plan wins about " << static_cast<int>(plan.winProbability * 100 + 0.5)
+                    << "% of the time)." << endl;
+            continue;
+        }
+        if (broadcast.size() != 2)
+        {
+            cout << "You must specify a channel followed by a direction." << endl;
+            continue;
+        }
+        int channel = decodeChannel(broadcast[0]);
+        if (channel < 1 || channel > m_arena->channels())
+            cout << "Channel must be in the range 1 through "
+            << channelSymbol(m_arena->channels()) << "." << endl;
+        else
+        {
+            int dir = decodeDirection(tolower(broadcast[1]));
+            if (dir == BADDIR)
+                cout << "Direction must be n, e, s, or w." << endl;
+            else
+                return m_arena->moveCyborgs(channel, dir);
+        }
+    }
+}
+
+void Game::play()
+{
+    m_arena->display("");
+    Player* player = m_arena->player();
+    if (player == nullptr)
+        return;
+    while (!player->isDead() && m_arena->cyborgCount() > 0)
+    {
+        string msg = takePlayerTurn();
+        if (m_inputClosed)
+            break;
+        m_arena->display(msg);
+        if (player->isDead())
+            break;
+        msg = takeCyborgsTurn();
+        if (m_inputClosed)
+            break;
+        m_arena->display(msg);
+    }
+    if (m_inputClosed)
+        cout << endl << "Input ended; game abandoned." << endl;
+    else if (player->isDead())
+        cout << "You lose." << endl;
+    else
+        cout << "You win." << endl;
+}
+
+///////////////////////////////////////////////////////////////////////////
+//  Auxiliary function implementations
+///////////////////////////////////////////////////////////////////////////
+
+void populateArena(Arena& a, int nCyborgs)
+{
+    int rows = a.rows();
+    int cols = a.cols();
+    int nEmpty = rows * cols - nCyborgs - 1;  // 1 for Player
+    assert(nEmpty >= 0);
+
+    // Add some walls in WALL_DENSITY of the empty spots
+    assert(WALL_DENSITY >= 0 && WALL_DENSITY <= 1);
+    int nWalls = static_cast<int>(WALL_DENSITY * nEmpty);
+    while (nWalls > 0)
+    {
+        int r = randInt(1, rows);
+        int c = randInt(1, cols);
+        if (a.hasWallAt(r, c))
+            continue;
+        a.placeWallAt(r, c);
+        nWalls--;
+    }
+
+    // Add player, in the largest open region: walls placed at random can
+    // seal off pockets, and one could trap the player for the whole game
+    a.buildTopology();
+    const WallTopology& topology = a.topology();
+    int rPlayer;
+    int cPlayer;
+    do
+    {
+        rPlayer = randInt(1, rows);
+        cPlayer = randInt(1, cols);
+    } while (topology.region(rPlayer, cPlayer) != topology.largestRegion());
+    a.addPlayer(rPlayer, cPlayer);
+
+    // Populate with cyborgs
+    while (nCyborgs > 0)
+    {
+        int r = randInt(1, rows);
+        int c = randInt(1, cols);
+        if (a.hasWallAt(r, c) || (r == rPlayer && c == cPlayer))
+            continue;
+        a.addCyborg(r, c, randInt(1, a.channels()));
+        nCyborgs--;
+    }
+}
+
+}  // namespace cyborgs
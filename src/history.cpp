@@ -0,0 +1,109 @@
+// history.cpp
+
+#include "cyborgs/history.h"
+
+#include <iostream>
+#include <cstdlib>
+using namespace std;
+
+namespace cyborgs
+{
+
+///////////////////////////////////////////////////////////////////////////
+//  TurnDelta implementation
+///////////////////////////////////////////////////////////////////////////
+
+size_t TurnDelta::bytes() const
+{
+    return sizeof(TurnDelta) + steps.size() * sizeof(unsigned char)
+        + (removed.size() + snapshot.size()) * sizeof(CyborgRecord)
+        + channelStart.size() * sizeof(int);
+}
+
+///////////////////////////////////////////////////////////////////////////
+//  TurnHistory implementation
+///////////////////////////////////////////////////////////////////////////
+
+TurnHistory::TurnHistory(int maxTurns, int keyframeInterval)
+{
+    if (maxTurns < 1 || keyframeInterval < 1)
+    {
+        cout << "***** Turn history of " << maxTurns << " turns with a keyframe every "
+            << keyframeInterval << "!" << endl;
+        exit(1);
+    }
+    m_maxTurns = maxTurns;
+    m_keyframeInterval = keyframeInterval;
+    m_turn = 0;
+    m_oldest = 0;
+    m_newest = 0;
+    m_begun = false;
+}
+
+long long TurnHistory::keyframeBefore(long long t) const
+{
+    long long k = t - t % m_keyframeInterval;
+    if (k >= m_newest)
+        k -= m_keyframeInterval;  // turn t has no delta yet
+    return (k >= m_oldest ? k : -1);
+}
+
+size_t TurnHistory::memoryUsed() const
+{
+    size_t total = sizeof(TurnHistory) + m_ring.capacity() * sizeof(TurnDelta);
+    for (size_t i = 0; i < m_ring.size(); i++)
+    {
+        const TurnDelta& d = m_ring[i];
+        total += d.steps.capacity() * sizeof(unsigned char)
+            + (d.removed.capacity() + d.snapshot.capacity()) * sizeof(CyborgRecord)
+            + d.channelStart.capacity() * sizeof(int);
+    }
+    return total;
+}
+
+void TurnHistory::beginTurn(const PlayerRecord& player)
+{
+    m_pending = player;
+    m_begun = true;
+}
+
+TurnDelta& TurnHistory::recordTurn(const PlayerRecord& player)
+{
+    // Turns undone are lost for good, and the oldest turn makes way when
+    // the ring is full.  The slot's buffers keep their capacity.  Turns
+    // only ever advance one at a time, so the ring grows at its end.
+    m_newest = m_turn;
+    if (m_newest - m_oldest == m_maxTurns)
+        m_oldest++;
+    size_t slot = static_cast<size_t>(m_turn % m_maxTurns);
+    if (slot == m_ring.size())
+        m_ring.emplace_back();
+    TurnDelta& d = m_ring[slot];
+    d.steps.clear();
+    d.channel = 0;
+    d.removed.clear();
+    d.playerBefore = (m_begun ? m_pending : player);
+    d.playerAfter = d.playerBefore;
+    d.keyframe = (m_turn % m_keyframeInterval == 0);
+    d.snapshot.clear();
+    d.channelStart.clear();
+    m_begun = false;
+    m_turn++;
+    m_newest = m_turn;
+    return d;
+}
+
+void TurnHistory::setTurn(long long t)
+{
+    m_turn = t;
+    m_begun = false;
+}
+
+void TurnHistory::clear()
+{
+    m_oldest = m_turn;
+    m_newest = m_turn;
+    m_begun = false;
+}
+
+}  // namespace cyborgs
@@ -0,0 +1,23 @@
+// memory.cpp
+
+#include "cyborgs/memory.h"
+
+#include <iostream>
+#include <cstdlib>
+using namespace std;
+
+namespace cyborgs
+{
+
+///////////////////////////////////////////////////////////////////////////
+//  BumpAllocator implementation
+///////////////////////////////////////////////////////////////////////////
+
+void BumpAllocator::reportExhausted(size_t bytes) const
+{
+    cout << "***** BumpAllocator out of memory: " << bytes << " bytes requested, "
+        << (m_capacity - m_used) << " of " << m_capacity << " left" << endl;
+    exit(1);
+}
+
+}  // namespace cyborgs
@@ -0,0 +1,369 @@
+// planner.cpp
+
+#include "cyborgs/planner.h"
+#include "cyborgs/arena.h"
+#include "cyborgs/constants.h"
+#include "cyborgs/rng.h"
+#include "cyborgs/rules.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+using namespace std;
+
+namespace cyborgs
+{
+
+namespace
+{
+    typedef chrono::steady_clock Clock;
+
+    // Status of one particle
+    const char RUNNING = 0;
+    const char WON = 1;
+    const char LOST = 2;
+
+    // Share of the budget for the search; the rest scores the result
+    const double SEARCH_SHARE = 0.75;
+
+    // One step of a plan: the broadcast, then the player's reply
+    char playStep(Arena& a, const PlanStep& step)
+    {
+        a.moveCyborgs(step.channel, step.dir);
+        Player* p = a.player();
+        if (p->isDead())
+            return LOST;
+        if (a.cyborgCount() == 0)
+            return WON;
+        int dir;
+        if (recommendMove(a, p->row(), p->col(), dir))
+            p->move(dir);
+        return p->isDead() ? LOST : RUNNING;
+    }
+
+    int totalHealth(const Arena& a)
+    {
+        int total = 0;
+        for (int i = 0; i < a.cyborgCount(); i++)
+            total += a.cyborg(i).health();
+        return total;
+    }
+
+    // nThreads threads (the caller is one of them) kept for a whole
+    // search, each with its own scratch arena and random engine.  run(n, f)
+    // calls f(i, scratch) for i in [0, n) across them and returns when
+    // every call has.
+    class WorkerPool
+    {
+    public:
+        WorkerPool(int nThreads, const Arena& like);
+        ~WorkerPool();
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        void run(int n, const function<void(int, Arena&)>& f);
+
+    private:
+        vector<unique_ptr<Arena> >        m_scratch;  // [t] for thread t; 0 is the caller
+        vector<thread>                    m_threads;
+        mutex                             m_mutex;
+        condition_variable                m_wake;     // a job was posted, or quit
+        condition_variable                m_done;     // the last worker finished
+        const function<void(int, Arena&)>* m_job;
+        int                               m_n;
+        atomic<int>                       m_next;
+        int                               m_busy;     // workers still on the job
+        long long                         m_generation;  // jobs posted
+        bool                              m_quit;
+
+        void work(int t);
+        void drain(Arena& scratch);
+    };
+
+    WorkerPool::WorkerPool(int nThreads, const Arena& like)
+        : m_job(nullptr), m_n(0), m_next(0), m_busy(0), m_generation(0), m_quit(false)
+    {
+        for (int t = 0; t < nThreads; t++)
+            m_scratch.emplace_back(new Arena(like.rows(), like.cols(), like.channels()));
+        for (int t = 1; t < nThreads; t++)
+            m_threads.emplace_back(&WorkerPool::work, this, t);
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_quit = true;
+        }
+        m_wake.notify_all();
+        for (size_t t = 0; t < m_threads.size(); t++)
+            m_threads[t].join();
+    }
+
+    void WorkerPool::run(int n, const function<void(int, Arena&)>& f)
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_job = &f;
+            m_n = n;
+            m_next = 0;
+            m_busy = static_cast<int>(m_threads.size());
+            m_generation++;
+        }
+        m_wake.notify_all();
+        drain(*m_scratch[0]);
+        unique_lock<mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_busy == 0; });
+        m_job = nullptr;
+    }
+
+    void WorkerPool::work(int t)
+    {
+        long long seen = 0;
+        unique_lock<mutex> lock(m_mutex);
+        for (;;)
+        {
+            m_wake.wait(lock, [&] { return m_quit || m_generation != seen; });
+            if (m_quit)
+                return;
+            seen = m_generation;
+            lock.unlock();
+            drain(*m_scratch[t]);
+            lock.lock();
+            if (--m_busy == 0)
+                m_done.notify_one();
+        }
+    }
+
+    void WorkerPool::drain(Arena& scratch)
+    {
+        for (int i = m_next++; i < m_n; i = m_next++)
+            (*m_job)(i, scratch);
+    }
+
+    // A plan prefix and where it leaves each particle
+    struct Node
+    {
+        vector<PlanStep> steps;
+        vector<Arena*>   particles;
+        vector<char>     status;
+    };
+
+    // A one-step extension of a beam node, scored but not yet kept
+    struct Candidate
+    {
+        int    parent;
+        int    action;
+        double score;
+        double winFrac;
+    };
+}
+
+///////////////////////////////////////////////////////////////////////////
+//  Auxiliary function implementations
+///////////////////////////////////////////////////////////////////////////
+
+Plan planBroadcasts(const Arena& a, const PlannerOptions& opts)
+{
+    Clock::time_point start = Clock::now();
+    Clock::time_point searchDeadline = start
+        + chrono::duration_cast<Clock::duration>(chrono::duration<double>(opts.timeBudget * SEARCH_SHARE));
+    Clock::time_point deadline = start
+        + chrono::duration_cast<Clock::duration>(chrono::duration<double>(opts.timeBudget));
+    int nThreads = opts.threads > 0 ? opts.threads
+        : max(1, static_cast<int>(thread::hardware_concurrency()));
+    int nParticles = max(1, opts.particles);
+    int beamWidth = max(1, opts.beamWidth);
+
+    Plan plan;
+    if (a.player() == nullptr || a.player()->isDead() || a.cyborgCount() == 0)
+    {
+        plan.winProbability = (a.player() != nullptr && !a.player()->isDead()) ? 1 : 0;
+        return plan;
+    }
+
+    // The copies share a's wall topology, so build it before they do
+    a.topology();
+
+    // The workers reseed their engines; the caller's is put back at the end.
+    // The same workers and scratch arenas serve every depth and the final
+    // evaluation.
+    default_random_engine callerEngine = randomEngine();
+    WorkerPool workers(nThreads, a);
+    atomic<long long> nTurns(0);
+
+    // Only broadcasts to channels that have cyborgs do anything useful
+    vector<PlanStep> actions;
+    for (int ch = 1; ch <= a.channels(); ch++)
+        if (a.cyborgCountOn(ch) > 0)
+            for (int dir = 0; dir < NUMDIRS; dir++)
+                actions.push_back({ ch, dir });
+    int nActions = static_cast<int>(actions.size());
+    double initialHealth = totalHealth(a);
+
+    // Two banks of beamWidth * nParticles arenas, swapped at each depth
+    vector<Arena*> banks[2];
+    for (int b = 0; b < 2; b++)
+        for (int i = 0; i < beamWidth * nParticles; i++)
+            banks[b].push_back(new Arena(a.rows(), a.cols(), a.channels()));
+    vector<Node> beam(1);
+    for (int p = 0; p < nParticles; p++)
+    {
+        banks[0][p]->copyFrom(a);
+        beam[0].particles.push_back(banks[0][p]);
+        beam[0].status.push_back(RUNNING);
+    }
+
+    Candidate best = { -1, -1, -1, -1 };
+    vector<PlanStep> bestSteps;
+    int bank = 0;
+    for (int depth = 0; depth < opts.horizon; depth++)
+    {
+        // Score every extension of every beam node on its particles.  All
+        // candidates at this depth see the same dice for particle p.
+        int nCandidates = static_cast<int>(beam.size()) * nActions;
+        vector<Candidate> candidates(nCandidates);
+        atomic<bool> outOfTime(false);
+        workers.run(nCandidates, [&](int i, Arena& scratch) {
+            if (outOfTime || Clock::now() > searchDeadline)
+            {
+                outOfTime = true;
+                return;
+            }
+            const Node& node = beam[i / nActions];
+            const PlanStep& step = actions[i % nActions];
+            double value = 0;
+            int wins = 0;
+            for (int p = 0; p < nParticles; p++)
+            {
+                char status = node.status[p];
+                if (status == RUNNING)
+                {
+                    scratch.copyFrom(*node.particles[p]);
+                    seedRandom(mixSeed(opts.seed, static_cast<unsigned long long>(depth) * nParticles + p));
+                    status = playStep(scratch, step);
+                    nTurns++;
+                }
+                if (status == WON)
+                {
+                    value += 1;
+                    wins++;
+                }
+                else if (status == RUNNING)
+                {
+                    // A live player is worth something; wearing the
+                    // cyborgs down is worth more
+                    value += 0.1 + 0.4 * (1 - totalHealth(scratch) / initialHealth);
+                }
+            }
+            candidates[i] = { i / nActions, i % nActions, value / nParticles,
+                static_cast<double>(wins) / nParticles };
+        });
+        if (outOfTime)
+        {
+            plan.timedOut = true;
+            break;
+        }
+        plan.depthSearched = depth + 1;
+
+        // Wins are permanent, so a longer plan never wins less often than
+        // its prefix; only a strictly better win rate replaces the best
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            const Candidate& c = candidates[i];
+            if (c.winFrac > best.winFrac
+                || (c.winFrac == best.winFrac && c.winFrac == 0 && c.score > best.score))
+            {
+                best = c;
+                bestSteps = beam[c.parent].steps;
+                bestSteps.push_back(actions[c.action]);
+            }
+        }
+        if (best.winFrac == 1)
+            break;
+
+        // Keep the best beamWidth candidates
+        sort(candidates.begin(), candidates.end(),
+            [](const Candidate& x, const Candidate& y) { return x.score > y.score; });
+        if (static_cast<int>(candidates.size()) > beamWidth)
+            candidates.resize(beamWidth);
+
+        // Rebuild the kept candidates' particles; reseeding the same way
+        // replays exactly the futures they were scored on
+        int nextBank = 1 - bank;
+        vector<Node> next(candidates.size());
+        for (size_t i = 0; i < next.size(); i++)
+        {
+            const Candidate& c = candidates[i];
+            next[i].steps = beam[c.parent].steps;
+            next[i].steps.push_back(actions[c.action]);
+            next[i].particles.assign(banks[nextBank].begin() + i * nParticles,
+                banks[nextBank].begin() + (i + 1) * nParticles);
+            next[i].status = beam[c.parent].status;
+        }
+        workers.run(static_cast<int>(next.size()) * nParticles, [&](int i, Arena&) {
+            Node& node = next[i / nParticles];
+            const Node& parent = beam[candidates[i / nParticles].parent];
+            int p = i % nParticles;
+            node.particles[p]->copyFrom(*parent.particles[p]);
+            if (node.status[p] == RUNNING)
+            {
+                seedRandom(mixSeed(opts.seed, static_cast<unsigned long long>(depth) * nParticles + p));
+                node.status[p] = playStep(*node.particles[p], node.steps.back());
+                nTurns++;
+            }
+        });
+        beam.swap(next);
+        bank = nextBank;
+
+        bool allOver = true;
+        for (size_t i = 0; i < beam.size() && allOver; i++)
+            for (int p = 0; p < nParticles && allOver; p++)
+                allOver = (beam[i].status[p] != RUNNING);
+        if (allOver)
+            break;
+    }
+    for (int b = 0; b < 2; b++)
+        for (size_t i = 0; i < banks[b].size(); i++)
+            delete banks[b][i];
+
+    // Score the chosen plan on fresh dice; the search's own estimate is
+    // biased upward by having picked the plan that did best on its particles
+    plan.steps = bestSteps;
+    if (!plan.steps.empty())
+    {
+        unsigned int evalSeed = mixSeed(opts.seed, ~0ULL);
+        int nSteps = static_cast<int>(plan.steps.size());
+        atomic<int> nRun(0);
+        atomic<int> nWon(0);
+        workers.run(max(0, opts.evalRollouts), [&](int r, Arena& scratch) {
+            if (Clock::now() > deadline)
+                return;
+            scratch.copyFrom(a);
+            char status = RUNNING;
+            for (int s = 0; s < nSteps && status == RUNNING; s++)
+            {
+                seedRandom(mixSeed(evalSeed, static_cast<unsigned long long>(r) * nSteps + s));
+                status = playStep(scratch, plan.steps[s]);
+                nTurns++;
+            }
+            nRun++;
+            if (status == WON)
+                nWon++;
+        });
+        plan.rollouts = nRun;
+        plan.winProbability = (nRun > 0 ? static_cast<double>(nWon) / nRun : best.winFrac);
+    }
+    plan.simulatedTurns = nTurns;
+    randomEngine() = callerEngine;
+    return plan;
+}
+
+}  // namespace cyborgs
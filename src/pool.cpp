@@ -0,0 +1,55 @@
+// pool.cpp
+
+#include "cyborgs/pool.h"
+#include "cyborgs/arena.h"
+
+#include <cstddef>
+using namespace std;
+
+namespace cyborgs
+{
+
+///////////////////////////////////////////////////////////////////////////
+//  ArenaPool implementation
+///////////////////////////////////////////////////////////////////////////
+
+ArenaPool::ArenaPool()
+{
+}
+
+ArenaPool::~ArenaPool()
+{
+    for (size_t i = 0; i < m_idle.size(); i++)
+        delete m_idle[i];
+}
+
+int ArenaPool::idleCount() const
+{
+    return static_cast<int>(m_idle.size());
+}
+
+size_t ArenaPool::idleMemory() const
+{
+    size_t total = 0;
+    for (size_t i = 0; i < m_idle.size(); i++)
+        total += m_idle[i]->memoryUsed();
+    return total;
+}
+
+Arena* ArenaPool::acquire(int rows, int cols, int nChannels)
+{
+    if (m_idle.empty())
+        return new Arena(rows, cols, nChannels);
+    Arena* a = m_idle.back();
+    m_idle.pop_back();
+    a->reset(rows, cols, nChannels);
+    return a;
+}
+
+void ArenaPool::release(Arena* a)
+{
+    if (a != nullptr)
+        m_idle.push_back(a);
+}
+
+}  // namespace cyborgs
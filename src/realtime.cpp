@@ -0,0 +1,301 @@
+// realtime.cpp
+
+#include "cyborgs/realtime.h"
+#include "cyborgs/arena.h"
+#include "cyborgs/frames.h"
+#include "cyborgs/game.h"
+#include "cyborgs/render.h"
+#include "cyborgs/rng.h"
+#include "cyborgs/rules.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <cctype>
+#include <csignal>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <conio.h>
+#else
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+namespace cyborgs
+{
+
+namespace
+{
+    typedef chrono::steady_clock Clock;
+
+    const int NOKEY = -2;  // no player key this tick (BADDIR means stand)
+
+    volatile sig_atomic_t interrupted = 0;
+
+    void onInterrupt(int)
+    {
+        interrupted = 1;
+    }
+
+    // Non-blocking keyboard input, in raw mode for the life of the object
+    // when stdin is a terminal
+    class Keyboard
+    {
+    public:
+        Keyboard();
+        ~Keyboard();
+        Keyboard(const Keyboard&) = delete;
+        Keyboard& operator=(const Keyboard&) = delete;
+
+        int nextKey();  // -1 if no key is waiting
+
+    private:
+#ifndef _WIN32
+        bool    m_closed;  // stdin hit end of file
+        bool    m_raw;
+        termios m_saved;
+#endif
+    };
+
+#ifdef _WIN32
+
+    Keyboard::Keyboard()
+    {
+    }
+
+    Keyboard::~Keyboard()
+    {
+    }
+
+    int Keyboard::nextKey()
+    {
+        return _kbhit() ? _getch() : -1;
+    }
+
+#else  // not _WIN32
+
+    Keyboard::Keyboard()
+    {
+        m_closed = false;
+        m_raw = false;
+        if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &m_saved) == 0)
+        {
+            // Keys arrive one at a time, unechoed, and read() never waits
+            termios raw = m_saved;
+            raw.c_lflag &= ~(ICANON | ECHO);
+            raw.c_cc[VMIN] = 0;
+            raw.c_cc[VTIME] = 0;
+            m_raw = (tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0);
+        }
+    }
+
+    Keyboard::~Keyboard()
+    {
+        if (m_raw)
+            tcsetattr(STDIN_FILENO, TCSANOW, &m_saved);
+    }
+
+    int Keyboard::nextKey()
+    {
+        if (m_closed)
+            return -1;
+        pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+        if (poll(&pfd, 1, 0) <= 0)
+            return -1;
+        unsigned char ch;
+        if (read(STDIN_FILENO, &ch, 1) != 1)
+        {
+            m_closed = true;  // end of input; from now on the advisor plays
+            return -1;
+        }
+        return ch;
+    }
+
+#endif  // _WIN32
+
+    double millis(Clock::duration d)
+    {
+        return chrono::duration<double, milli>(d).count();
+    }
+
+    // Mean, 99th percentile and maximum of samples (which get reordered)
+    void summarize(vector<double>& samples, double& mean, double& p99, double& worst)
+    {
+        mean = p99 = worst = 0;
+        if (samples.empty())
+            return;
+        double sum = 0;
+        for (size_t i = 0; i < samples.size(); i++)
+            sum += samples[i];
+        mean = sum / samples.size();
+        worst = *max_element(samples.begin(), samples.end());
+        size_t k = samples.size() * 99 / 100;
+        nth_element(samples.begin(), samples.begin() + k, samples.end());
+        p99 = samples[k];
+    }
+
+    void publishFrame(const Arena& a, const RealtimeOptions& opts, long long tick, FrameBuffer& frames)
+    {
+        const Player* p = a.player();
+        int top = min(p->row() - opts.viewRows / 2, a.rows() - opts.viewRows + 1);
+        int left = min(p->col() - opts.viewCols / 2, a.cols() - opts.viewCols + 1);
+        Frame& f = frames.back();
+        renderView(a, top, left, opts.viewRows, opts.viewCols, f.grid);
+        f.turn = tick;
+        f.game = 1;
+        f.cyborgs = a.cyborgCount();
+        f.playerDead = p->isDead();
+        frames.publish();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+//  Auxiliary function implementations
+///////////////////////////////////////////////////////////////////////////
+
+TickStats playRealtime(const RealtimeOptions& opts, ostream& out)
+{
+    if (opts.cyborgs < 0 || static_cast<long long>(opts.rows) * opts.cols - opts.cyborgs - 1 < 0
+        || !(opts.hz > 0))  // NaN too
+    {
+        cout << "***** Real-time game with a " << opts.rows << " by " << opts.cols
+            << " arena, " << opts.cyborgs << " cyborgs at " << opts.hz << " Hz!" << endl;
+        exit(1);
+    }
+
+    TickStats stats;
+    stats.ticks = 0;
+    stats.overruns = 0;
+    stats.budgetMs = 1000 / opts.hz;
+    stats.playerKeys = 0;
+    stats.broadcasts = 0;
+
+    seedRandom(opts.seed);
+    Arena arena(opts.rows, opts.cols, opts.channels, opts.cyborgs);
+    populateArena(arena, opts.cyborgs);
+    arena.sortCyborgs();
+    Player* player = arena.player();
+
+    FrameBuffer frames;
+    RenderThread renderer(frames, out, opts.hz);
+    publishFrame(arena, opts, 0, frames);
+    renderer.start();
+
+    Keyboard keys;
+    interrupted = 0;
+    void (*savedHandler)(int) = signal(SIGINT, onInterrupt);
+
+    vector<double> work;
+    vector<double> jitter;
+    Clock::duration period = chrono::duration_cast<Clock::duration>(chrono::duration<double>(1 / opts.hz));
+    Clock::time_point next = Clock::now() + period;
+    int pendingChannel = 0;  // channel typed, direction still to come
+    bool quit = false;
+    while (!quit && !interrupted)
+    {
+        this_thread::sleep_until(next);
+        Clock::time_point begin = Clock::now();
+        jitter.push_back(millis(begin - next));
+
+        // Keys typed since the last tick; the last of each kind wins
+        int playerDir = NOKEY;
+        int channel = 0;
+        int dir = BADDIR;
+        for (int k = keys.nextKey(); k != -1; k = keys.nextKey())
+        {
+            if (pendingChannel != 0)
+            {
+                int d = decodeDirection(static_cast<char>(tolower(k)));
+                if (d != BADDIR)
+                {
+                    channel = pendingChannel;
+                    dir = d;
+                }
+                pendingChannel = 0;
+            }
+            else if (k == 'q')
+                quit = true;
+            else if (k == 'x')
+                playerDir = BADDIR;
+            else if (decodeDirection(static_cast<char>(k)) != BADDIR)
+                playerDir = decodeDirection(static_cast<char>(k));
+            else if (isdigit(k) || isupper(k))  // lower case letters are commands
+            {
+                int ch = decodeChannel(static_cast<char>(k));
+                if (ch >= 1 && ch <= arena.channels())
+                    pendingChannel = ch;
+            }
+        }
+
+        // The turn, as Game::play runs it, with fallbacks for missed input
+        bool over = player->isDead() || arena.cyborgCount() == 0;
+        if (!over)
+        {
+            if (playerDir == NOKEY)
+            {
+                int d;
+                if (recommendMove(arena, player->row(), player->col(), d))
+                    player->move(d);
+            }
+            else
+            {
+                stats.playerKeys++;
+                if (playerDir != BADDIR)
+                    player->move(playerDir);
+            }
+        }
+        if (!player->isDead())
+        {
+            if (dir != BADDIR && !over)
+            {
+                stats.broadcasts++;
+                arena.moveCyborgs(channel, dir);
+            }
+            else
+                arena.moveCyborgs(0, BADDIR);
+        }
+        else if (opts.maxTicks > 0)
+            arena.moveCyborgs(0, BADDIR);  // keep the load up to the last tick
+        stats.ticks++;
+        publishFrame(arena, opts, stats.ticks, frames);
+
+        double ms = millis(Clock::now() - begin);
+        work.push_back(ms);
+        if (ms > stats.budgetMs)
+            stats.overruns++;
+        over = player->isDead() || arena.cyborgCount() == 0;
+        if (opts.maxTicks > 0 ? stats.ticks >= opts.maxTicks : over)
+            quit = true;
+
+        // Ticks that can no longer start on time are skipped, not bunched up
+        next += period;
+        Clock::time_point now = Clock::now();
+        while (next < now)
+            next += period;
+    }
+    signal(SIGINT, savedHandler);
+    renderer.stop();
+
+    stats.lost = player->isDead();
+    stats.won = !stats.lost && arena.cyborgCount() == 0;
+    summarize(work, stats.meanWorkMs, stats.p99WorkMs, stats.worstWorkMs);
+    summarize(jitter, stats.meanJitterMs, stats.p99JitterMs, stats.worstJitterMs);
+    return stats;
+}
+
+void printTickStats(const TickStats& stats, ostream& out)
+{
+    out << "Ticks: " << stats.ticks << " with a " << stats.budgetMs << " ms budget; "
+        << stats.playerKeys << " player keys, " << stats.broadcasts << " broadcasts" << '\n'
+        << "Work:   mean " << stats.meanWorkMs << " ms, p99 " << stats.p99WorkMs
+        << " ms, worst " << stats.worstWorkMs << " ms, " << stats.overruns << " over budget" << '\n'
+        << "Jitter: mean " << stats.meanJitterMs << " ms, p99 " << stats.p99JitterMs
+        << " ms, worst " << stats.worstJitterMs << " ms" << endl;
+}
+
+}  // namespace cyborgs
@@ -0,0 +1,150 @@
+// render.cpp
+
+#include "cyborgs/render.h"
+#include "cyborgs/arena.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+using namespace std;
+
+namespace cyborgs
+{
+
+///////////////////////////////////////////////////////////////////////////
+//  Renderer implementation
+///////////////////////////////////////////////////////////////////////////
+
+void renderGrid(const Arena& a, string& out)
+{
+    renderView(a, 1, 1, a.rows(), a.cols(), out);
+}
+
+void renderView(const Arena& a, int top, int left, int nRows, int nCols, string& out)
+{
+    // Clip the window to the arena
+    if (top < 1)
+        top = 1;
+    if (left < 1)
+        left = 1;
+    int bottom = min(top + nRows - 1, a.rows());
+    int right = min(left + nCols - 1, a.cols());
+    nRows = max(0, bottom - top + 1);
+    nCols = max(0, right - left + 1);
+    int width = nCols + 1;  // + 1 for the newline ending each row
+
+    // Fill the grid with dots (empty) and stars (wall)
+    out.assign(static_cast<size_t>(nRows) * width, '.');
+    for (int r = 0; r < nRows; r++)
+    {
+        for (int c = 0; c < nCols; c++)
+            if (a.hasWallAt(top + r, left + c))
+                out[r * width + c] = '*';
+        out[(r + 1) * width - 1] = '\n';
+    }
+
+    // Cyborgs show as their channel symbol
+    for (int i = 0; i < a.cyborgCount(); i++)
+    {
+        const Cyborg& cy = a.cyborg(i);
+        int r = cy.row() - top;
+        int c = cy.col() - left;
+        if (r >= 0 && r < nRows && c >= 0 && c < nCols)
+            out[r * width + c] = channelSymbol(cy.channel());
+    }
+
+    // Indicate player's position
+    const Player* p = a.player();
+    if (p != nullptr)
+    {
+        int r = p->row() - top;
+        int c = p->col() - left;
+        if (r >= 0 && r < nRows && c >= 0 && c < nCols)
+            out[r * width + c] = (p->isDead() ? 'X' : '@');
+    }
+}
+
+void renderArena(const Arena& a, const string& msg, ostream& out)
+{
+    string grid;
+    renderGrid(a, grid);
+    out << grid << '\n';
+
+    // Write message, cyborg, and player info
+    if (msg != "")
+        out << msg << '\n';
+    out << "There are " << a.cyborgCount() << " cyborgs remaining." << '\n';
+    if (a.player() == nullptr)
+        out << "There is no player!" << '\n';
+    else if (a.player()->isDead())
+        out << "The player is dead." << '\n';
+    out << flush;
+}
+
+void Arena::display(string msg) const
+{
+    clearScreen();
+    renderArena(*this, msg, cout);
+}
+
+}  // namespace cyborgs
+
+///////////////////////////////////////////////////////////////////////////
+//  clearScreen implementation
+///////////////////////////////////////////////////////////////////////////
+
+// DO NOT MODIFY OR REMOVE ANYTHING BETWEEN HERE AND THE END OF THE FILE!!!
+// THE CODE IS SUITABLE FOR VISUAL C++, XCODE, AND g++/g31 UNDER LINUX.
+
+// Note to Xcode users:  clearScreen() will just write a newline instead
+// of clearing the window if you launch your program from within Xcode.
+// That's acceptable.  (The Xcode output window doesn't have the capability
+// of being cleared.)
+
+#ifdef _WIN32
+
+#pragma warning(disable : 4005)
+#include <windows.h>
+
+namespace cyborgs
+{
+
+void clearScreen()
+{
+    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    GetConsoleScreenBufferInfo(hConsole, &csbi);
+    DWORD dwConSize = csbi.dwSize.X * csbi.dwSize.Y;
+    COORD upperLeft = { 0, 0 };
+    DWORD dwCharsWritten;
+    FillConsoleOutputCharacter(hConsole, TCHAR(' '), dwConSize, upperLeft,
+        &dwCharsWritten);
+    SetConsoleCursorPosition(hConsole, upperLeft);
+}
+
+}  // namespace cyborgs
+
+#else  // not _WIN32
+
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+
+namespace cyborgs
+{
+
+void clearScreen()  // will just write a newline in an Xcode output window
+{
+    static const char* term = getenv("TERM");
+    if (term == nullptr || strcmp(term, "dumb") == 0)
+        cout << endl;
+    else
+    {
+        static const char* ESC_SEQ = "\x1B[";  // ANSI Terminal esc seq:  ESC [
+        cout << ESC_SEQ << "2J" << ESC_SEQ << "H" << flush;
+    }
+}
+
+}  // namespace cyborgs
+
+#endif
@@ -0,0 +1,93 @@
+// rules.cpp
+
+#include "cyborgs/rules.h"
+#include "cyborgs/arena.h"
+#include "cyborgs/constants.h"
+
+#include <algorithm>
+#include <cstddef>
+using namespace std;
+
+namespace cyborgs
+{
+
+///////////////////////////////////////////////////////////////////////////
+//  Auxiliary function implementations
+///////////////////////////////////////////////////////////////////////////
+
+int decodeDirection(char dir)
+{
+    switch (dir)
+    {
+    case 'n':  return NORTH;
+    case 'e':  return EAST;
+    case 's':  return SOUTH;
+    case 'w':  return WEST;
+    }
+    return BADDIR;  // bad argument passed in!
+}
+
+int decodeChannel(char ch)
+{
+    if (ch >= '1' && ch <= '9')
+        return ch - '0';
+    if (ch >= 'A' && ch <= 'Z')
+        return ch - 'A' + 10;
+    if (ch >= 'a' && ch <= 'z')
+        return ch - 'a' + 10;
+    return 0;
+}
+
+// Recommend a move for a player at (r,c): 
+bool recommendMove(const Arena& a, int r, int c, int& bestDir)
+{
+    // How far the player can see each way: to the nearest wall, counting
+    // its cell, or else to the edge; then cut short by the nearest cyborg
+    const WallTopology& t = a.topology();
+    int closestCyb[NUMDIRS];
+    closestCyb[NORTH] = t.wallDistance(r, c, NORTH);
+    closestCyb[NORTH] += (r - closestCyb[NORTH] > 1);
+    closestCyb[EAST] = t.wallDistance(r, c, EAST);
+    closestCyb[EAST] += (c + closestCyb[EAST] < a.cols());
+    closestCyb[SOUTH] = t.wallDistance(r, c, SOUTH);
+    closestCyb[SOUTH] += (r + closestCyb[SOUTH] < a.rows());
+    closestCyb[WEST] = t.wallDistance(r, c, WEST);
+    closestCyb[WEST] += (c - closestCyb[WEST] > 1);
+    for (int k = 0; k < a.cyborgCount(); k++)
+    {
+        const Cyborg& cy = a.cyborg(k);
+        if (cy.col() == c)
+        {
+            if (cy.row() < r)
+                closestCyb[NORTH] = min(closestCyb[NORTH], r - cy.row());
+            else if (cy.row() > r)
+                closestCyb[SOUTH] = min(closestCyb[SOUTH], cy.row() - r);
+        }
+        else if (cy.row() == r)
+        {
+            if (cy.col() > c)
+                closestCyb[EAST] = min(closestCyb[EAST], cy.col() - c);
+            else
+                closestCyb[WEST] = min(closestCyb[WEST], c - cy.col());
+        }
+    }
+
+    if (closestCyb[0] == closestCyb[1] && closestCyb[0] == closestCyb[2] && closestCyb[0] == closestCyb[3])
+        return false;
+
+    int max = 0;
+    for (size_t i = 0; i < NUMDIRS; i++)
+    {
+        size_t j = i;
+        while (j != NUMDIRS)
+        {
+            if (closestCyb[j] > closestCyb[max])
+                max = j;
+            j++;
+        }
+    }
+    bestDir = max;
+    return true;
+}
+
+}  // namespace cyborgs
@@ -0,0 +1,230 @@
+// session.cpp
+
+#include "cyborgs/session.h"
+#include "cyborgs/arena.h"
+#include "cyborgs/constants.h"
+#include "cyborgs/game.h"
+#include "cyborgs/render.h"
+#include "cyborgs/rng.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+using namespace std;
+
+namespace cyborgs
+{
+
+///////////////////////////////////////////////////////////////////////////
+//  Session implementation
+///////////////////////////////////////////////////////////////////////////
+
+Session::Session(Arena& arena, int nCyborgs, unsigned int seed)
+{
+    restart(arena, nCyborgs, seed);
+}
+
+void Session::restart(Arena& arena, int nCyborgs, unsigned int seed)
+{
+    if (arena.rows() > MAXROWS || arena.cols() > MAXCOLS
+        || nCyborgs < 0 || nCyborgs > MAXCYBORGS
+        || arena.rows() * arena.cols() - nCyborgs - 1 < 0)
+    {
+        cout << "***** Session created with a " << arena.rows() << " by "
+            << arena.cols() << " arena and " << nCyborgs << " cyborgs!" << endl;
+        exit(1);
+    }
+    m_arena = &arena;
+    m_seed = seed;
+    m_tick = 0;
+    m_hasPlayerMove = false;
+    m_playerMove = BADDIR;
+    m_broadcasts.clear();
+    seedRandom(seed);
+    populateArena(*m_arena, nCyborgs);
+    renderGrid(*m_arena, m_grid);
+}
+
+const Arena& Session::arena() const
+{
+    return *m_arena;
+}
+
+long Session::tick() const
+{
+    return m_tick;
+}
+
+bool Session::isOver() const
+{
+    return m_arena->player()->isDead() || m_arena->cyborgCount() == 0;
+}
+
+size_t Session::memoryUsed() const
+{
+    return sizeof(Session) + m_grid.capacity() + m_scratch.capacity()
+        + m_broadcasts.capacity() * sizeof(Broadcast) + m_arena->memoryUsed();
+}
+
+void Session::snapshot(string& out) const
+{
+    out += "F " + to_string(m_tick) + ' ' + to_string(m_arena->rows()) + ' '
+        + to_string(m_arena->cols()) + ' ' + to_string(m_arena->cyborgCount()) + ' ';
+    for (size_t i = 0; i < m_grid.size(); i++)
+        out += (m_grid[i] == '\n' ? '/' : m_grid[i]);
+    out.back() = '\n';
+}
+
+void Session::submitPlayerMove(int dir)
+{
+    m_hasPlayerMove = true;
+    m_playerMove = dir;
+}
+
+void Session::submitBroadcast(int member, int channel, int dir)
+{
+    m_broadcasts.push_back({ member, channel, dir });
+}
+
+bool Session::step(string& out)
+{
+    if (isOver())
+    {
+        m_hasPlayerMove = false;
+        m_broadcasts.clear();
+        return false;
+    }
+    if (!m_hasPlayerMove && m_broadcasts.empty())
+        return false;
+
+    m_tick++;
+    seedRandom(mixSeed(m_seed, m_tick));
+
+    // Player first, as in Game::play, then every broadcast in channel and
+    // member order so arrival order within the tick doesn't matter.  Join
+    // order, unlike a socket number, is the same in every replay.
+    Player* player = m_arena->player();
+    if (m_hasPlayerMove && m_playerMove != BADDIR)
+        player->move(m_playerMove);
+    stable_sort(m_broadcasts.begin(), m_broadcasts.end(),
+        [](const Broadcast& a, const Broadcast& b) {
+            return a.channel != b.channel ? a.channel < b.channel : a.member < b.member;
+        });
+    for (const Broadcast& b : m_broadcasts)
+    {
+        if (isOver())
+            break;
+        m_arena->moveCyborgs(b.channel, b.dir);
+    }
+    m_hasPlayerMove = false;
+    m_broadcasts.clear();
+
+    // Delta: every cell whose character changed since the last tick
+    renderGrid(*m_arena, m_scratch);
+    int width = m_arena->cols() + 1;
+    string cells;
+    int nChanged = 0;
+    for (size_t i = 0; i < m_scratch.size(); i++)
+    {
+        if (m_scratch[i] == m_grid[i])
+            continue;
+        cells += ' ' + to_string(i / width + 1) + ' ' + to_string(i % width + 1) + ' ' + m_scratch[i];
+        nChanged++;
+    }
+    m_grid.swap(m_scratch);
+    out += "D " + to_string(m_tick) + ' ' + to_string(m_arena->cyborgCount()) + ' '
+        + to_string(nChanged) + cells + '\n';
+    if (isOver())
+        out += (player->isDead() ? "E LOSE\n" : "E WIN\n");
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////
+//  SessionHost implementation
+///////////////////////////////////////////////////////////////////////////
+
+SessionHost::SessionHost()
+{
+    m_nOpen = 0;
+}
+
+SessionHost::~SessionHost()
+{
+    for (size_t i = 0; i < m_slots.size(); i++)
+        close(static_cast<int>(i) + 1);
+    for (size_t i = 0; i < m_idle.size(); i++)
+        delete m_idle[i];
+}
+
+Session* SessionHost::find(int id) const
+{
+    if (id < 1 || id > static_cast<int>(m_slots.size()))
+        return nullptr;
+    return m_slots[id - 1];
+}
+
+int SessionHost::sessionCount() const
+{
+    return m_nOpen;
+}
+
+size_t SessionHost::memoryUsed(int id) const
+{
+    Session* s = find(id);
+    return s == nullptr ? 0 : s->memoryUsed();
+}
+
+size_t SessionHost::totalMemory() const
+{
+    size_t total = m_arenas.idleMemory();
+    for (size_t i = 0; i < m_slots.size(); i++)
+        if (m_slots[i] != nullptr)
+            total += m_slots[i]->memoryUsed();
+    for (size_t i = 0; i < m_idle.size(); i++)
+        total += sizeof(Session);
+    return total;
+}
+
+int SessionHost::open(int rows, int cols, int nCyborgs, unsigned int seed, int nChannels)
+{
+    Arena* a = m_arenas.acquire(rows, cols, nChannels);
+    Session* s;
+    if (m_idle.empty())
+        s = new Session(*a, nCyborgs, seed);
+    else
+    {
+        s = m_idle.back();
+        m_idle.pop_back();
+        s->restart(*a, nCyborgs, seed);
+    }
+
+    int id;
+    if (m_freeIds.empty())
+    {
+        m_slots.push_back(s);
+        id = static_cast<int>(m_slots.size());
+    }
+    else
+    {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+        m_slots[id - 1] = s;
+    }
+    m_nOpen++;
+    return id;
+}
+
+void SessionHost::close(int id)
+{
+    Session* s = find(id);
+    if (s == nullptr)
+        return;
+    m_arenas.release(s->m_arena);
+    m_idle.push_back(s);
+    m_slots[id - 1] = nullptr;
+    m_freeIds.push_back(id);
+    m_nOpen--;
+}
+
+}  // namespace cyborgs
@@ -0,0 +1,130 @@
+// soak.cpp
+
+#include "cyborgs/soak.h"
+#include "cyborgs/arena.h"
+#include "cyborgs/frames.h"
+#include "cyborgs/game.h"
+#include "cyborgs/render.h"
+#include "cyborgs/rng.h"
+#include "cyborgs/rules.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+using namespace std;
+
+namespace cyborgs
+{
+
+namespace
+{
+    // Turns between looks at the clock
+    const int CLOCK_STRIDE = 256;
+
+    // One turn as Game::play runs it, with the player taking the advice
+    // and the broadcast chosen at random.  Returns false once the game is over.
+    bool playTurn(Arena& a)
+    {
+        Player* p = a.player();
+        int dir;
+        if (recommendMove(a, p->row(), p->col(), dir))
+            p->move(dir);
+        if (p->isDead())
+            return false;
+        a.moveCyborgs(randInt(1, a.channels()), randInt(0, NUMDIRS - 1));
+        return !p->isDead() && a.cyborgCount() > 0;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+//  Auxiliary function implementations
+///////////////////////////////////////////////////////////////////////////
+
+SoakStats runSoak(const SoakOptions& opts, ostream& out)
+{
+    if (opts.cyborgs < 0 || opts.cyborgs > MAXCYBORGS
+        || opts.rows * opts.cols - opts.cyborgs - 1 < 0)
+    {
+        cout << "***** Soak run with a " << opts.rows << " by " << opts.cols
+            << " arena and " << opts.cyborgs << " cyborgs!" << endl;
+        exit(1);
+    }
+    if (!(opts.seconds > 0) || !(opts.maxFps > 0))  // NaN too
+    {
+        cout << "***** Soak run for " << opts.seconds << " s at up to "
+            << opts.maxFps << " fps!" << endl;
+        exit(1);
+    }
+
+    SoakStats stats;
+    stats.turns = 0;
+    stats.games = 0;
+    stats.wins = 0;
+    stats.framesPublished = 0;
+    stats.framesDrawn = 0;
+
+    seedRandom(opts.seed);
+    Arena arena(opts.rows, opts.cols, opts.channels);
+    populateArena(arena, opts.cyborgs);
+    stats.games = 1;
+
+    FrameBuffer frames;
+    RenderThread renderer(frames, out, opts.maxFps);
+    if (opts.asyncRender)
+        renderer.start();
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    chrono::steady_clock::time_point end = start
+        + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(opts.seconds));
+    for (;;)
+    {
+        if (!playTurn(arena))
+        {
+            if (!arena.player()->isDead())
+                stats.wins++;
+            arena.reset(opts.rows, opts.cols, opts.channels);
+            populateArena(arena, opts.cyborgs);
+            stats.games++;
+        }
+        stats.turns++;
+
+        if (opts.asyncRender)
+        {
+            Frame& f = frames.back();
+            renderGrid(arena, f.grid);
+            f.turn = stats.turns;
+            f.game = stats.games;
+            f.cyborgs = arena.cyborgCount();
+            f.playerDead = arena.player()->isDead();
+            frames.publish();
+        }
+        else
+            arena.display("");
+
+        if (stats.turns % CLOCK_STRIDE == 0 && chrono::steady_clock::now() >= end)
+            break;
+    }
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    renderer.stop();
+    stats.framesPublished = frames.published();
+    stats.framesDrawn = (opts.asyncRender ? renderer.framesDrawn() : stats.turns);
+    return stats;
+}
+
+void printSoakStats(const SoakStats& stats, ostream& out)
+{
+    double secs = (stats.seconds > 0 ? stats.seconds : 1);
+    out << "Soak: " << stats.turns << " turns in " << stats.seconds << " s ("
+        << static_cast<long long>(stats.turns / secs) << " turns/s), "
+        << stats.games << " games, " << stats.wins << " won" << '\n'
+        << "Frames: " << stats.framesDrawn << " drawn (" << stats.framesDrawn / secs
+        << " fps)";
+    if (stats.framesPublished > 0)
+        out << ", " << stats.framesPublished - stats.framesDrawn << " of "
+            << stats.framesPublished << " published frames dropped";
+    out << endl;
+}
+
+}  // namespace cyborgs
@@ -0,0 +1,344 @@
+// topology.cpp
+
+#include "cyborgs/topology.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+using namespace std;
+
+namespace cyborgs
+{
+
+namespace
+{
+    // Below this many cells a thread, starting it costs more than it saves
+    const size_t MIN_CELLS_PER_THREAD = 1 << 16;
+
+    // Run f(b) for b in [0, nBands), one thread a band; the caller takes band 0
+    template<typename F>
+    void forEachBand(int nBands, F f)
+    {
+        if (nBands == 1)
+        {
+            f(0);
+            return;
+        }
+        vector<thread> workers;
+        for (int b = 1; b < nBands; b++)
+            workers.emplace_back(f, b);
+        f(0);
+        for (size_t t = 0; t < workers.size(); t++)
+            workers[t].join();
+    }
+
+    // First of n items in band b of nBands
+    int bandStart(int n, int nBands, int b)
+    {
+        return static_cast<int>(static_cast<long long>(n) * b / nBands);
+    }
+
+    // Union-find over runs, where a set's root is its first run.  Path
+    // halving; runs whose parent changes go in *touched.
+    int findRoot(int* parent, int x, vector<int>* touched)
+    {
+        while (parent[x] != x)
+        {
+            int up = parent[parent[x]];
+            if (touched != nullptr && up != parent[x])
+                touched->push_back(x);
+            parent[x] = up;
+            x = up;
+        }
+        return x;
+    }
+
+    void unite(int* parent, int x, int y, vector<int>* touched)
+    {
+        x = findRoot(parent, x, touched);
+        y = findRoot(parent, y, touched);
+        if (x == y)
+            return;
+        if (x > y)
+            swap(x, y);
+        parent[y] = x;
+        if (touched != nullptr)
+            touched->push_back(y);
+    }
+
+    // Join runs [a, aEnd) of one row to the runs [b, bEnd) of the row below
+    // that they overlap.  Both lists are in column order, so one sweep
+    // along them meets every overlapping pair.
+    void joinRows(const int* start, const int* length, int* parent,
+                  int a, int aEnd, int b, int bEnd, vector<int>* touched)
+    {
+        while (a < aEnd && b < bEnd)
+        {
+            int endA = start[a] + length[a];
+            int endB = start[b] + length[b];
+            if (start[a] < endB && start[b] < endA)
+                unite(parent, a, b, touched);
+            a += (endA <= endB);  // both when they end together
+            b += (endB <= endA);
+        }
+    }
+
+    // The move mask of a cell from whether it and its neighbours are
+    // walls, as 0 or 1.  Plain arithmetic, so that a row of them vectorizes.
+    unsigned char maskOf(int wall, int north, int east, int south, int west)
+    {
+        return static_cast<unsigned char>((wall - 1)
+            & ~(north << NORTH | east << EAST | south << SOUTH | west << WEST) & 0xF);
+    }
+
+    // The move masks of one row.  Off the board counts as wall: above and
+    // below may point at the row itself when there is no row there, and
+    // noNorth or noSouth is then 1.
+    void maskRow(const bool* here, const bool* above, const bool* below,
+                 int noNorth, int noSouth, int nCols, unsigned char* out)
+    {
+        if (nCols == 1)
+        {
+            out[0] = maskOf(here[0], above[0] | noNorth, 1, below[0] | noSouth, 1);
+            return;
+        }
+        out[0] = maskOf(here[0], above[0] | noNorth, here[1], below[0] | noSouth, 1);
+        for (int c = 1; c < nCols - 1; c++)
+            out[c] = maskOf(here[c], above[c] | noNorth, here[c + 1],
+                            below[c] | noSouth, here[c - 1]);
+        int c = nCols - 1;
+        out[c] = maskOf(here[c], above[c] | noNorth, 1, below[c] | noSouth, here[c - 1]);
+    }
+
+    // How many runs of open cells a row has: one for each open cell with a
+    // wall or the edge to its west
+    int countRuns(const bool* here, int nCols)
+    {
+        int n = !here[0];
+        for (int c = 1; c < nCols; c++)
+            n += (here[c - 1] > here[c]);
+        return n;
+    }
+
+    // Where the runs of open cells in a row begin and end, returning how
+    // many there are.  Each slot is written whether or not it is kept, to
+    // spare a branch a cell; begins and ends need (nCols + 1) / 2 + 1.
+    int findRuns(const bool* here, int nCols, int* begins, int* ends)
+    {
+        int nBegins = 0;
+        int nEnds = 0;
+        bool wasOpen = false;
+        for (int c = 0; c < nCols; c++)
+        {
+            bool open = !here[c];
+            begins[nBegins] = c;
+            nBegins += open & !wasOpen;
+            ends[nEnds] = c;
+            nEnds += wasOpen & !open;
+            wasOpen = open;
+        }
+        ends[nEnds] = nCols;
+        return nBegins;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+//  WallTopology implementation
+///////////////////////////////////////////////////////////////////////////
+
+WallTopology::WallTopology(const bool* walls, int nRows, int nCols, int nThreads)
+{
+    m_capacity = 0;
+    rebuild(walls, nRows, nCols, nThreads);
+}
+
+int WallTopology::wallDistance(int r, int c, int dir) const
+{
+    // Walked along the masks; a wall's own mask is 0
+    static const int rowStep[NUMDIRS] = { -1, 0, 1, 0 };
+    static const int colStep[NUMDIRS] = { 0, 1, 0, -1 };
+    ptrdiff_t step = static_cast<ptrdiff_t>(rowStep[dir]) * m_cols + colStep[dir];
+    const unsigned char* m = m_moves.get() + static_cast<size_t>(r - 1) * m_cols + (c - 1);
+    int n = 0;
+    for ( ; (*m >> dir) & 1; m += step)
+        n++;
+    return n;
+}
+
+int WallTopology::region(int r, int c) const
+{
+    // The last run in the row starting at or before c, if c is inside it
+    const int* first = m_runStart.data() + m_rowFirstRun[r - 1];
+    const int* last = m_runStart.data() + m_rowFirstRun[r];
+    const int* p = upper_bound(first, last, c - 1);
+    if (p == first)
+        return 0;
+    size_t j = (p - 1) - m_runStart.data();
+    return (c - 1 < m_runStart[j] + m_runLength[j]) ? m_runRegion[j] : 0;
+}
+
+void WallTopology::rebuild(const bool* walls, int nRows, int nCols, int nThreads)
+{
+    m_rows = nRows;
+    m_cols = nCols;
+    m_largest = 0;
+    size_t nCells = static_cast<size_t>(nRows) * nCols;
+    size_t maxThreads = max(static_cast<size_t>(1), nCells / MIN_CELLS_PER_THREAD);
+    if (maxThreads == 1)
+        nThreads = 1;  // and spare asking how many cores there are
+    else if (nThreads <= 0)
+        nThreads = max(1, static_cast<int>(thread::hardware_concurrency()));
+    nThreads = static_cast<int>(min(static_cast<size_t>(nThreads), maxThreads));
+    int rowBands = min(nThreads, nRows);
+
+    if (nCells > m_capacity)
+    {
+        m_moves.reset(new unsigned char[nCells]);
+        m_capacity = nCells;
+    }
+    unsigned char* moves = m_moves.get();
+    m_rowFirstRun.resize(nRows + 1);
+
+    // The move masks, and each band's runs of open cells, joined where
+    // they touch a run in the row above.  The runs are counted along with
+    // the masks, so that their tables are sized once rather than grown.
+    // Run numbers and m_rowFirstRun count from the start of the band until
+    // the bands are put together.
+    m_bandStart.resize(rowBands);
+    m_bandLength.resize(rowBands);
+    m_bandParent.resize(rowBands);
+    m_bandRow.resize(rowBands);
+    forEachBand(rowBands, [&](int b) {
+        int r0 = bandStart(nRows, rowBands, b);
+        int r1 = bandStart(nRows, rowBands, b + 1);
+        vector<int>& start = (b == 0 ? m_runStart : m_bandStart[b]);
+        vector<int>& length = (b == 0 ? m_runLength : m_bandLength[b]);
+        vector<int>& parent = (b == 0 ? m_parent : m_bandParent[b]);
+        int nRuns = 0;
+        for (int r = r0; r < r1; r++)
+        {
+            const bool* here = walls + static_cast<size_t>(r) * nCols;
+            maskRow(here, r > 0 ? here - nCols : here, r < nRows - 1 ? here + nCols : here,
+                    r == 0, r == nRows - 1, nCols, moves + static_cast<size_t>(r) * nCols);
+            m_rowFirstRun[r] = nRuns;
+            nRuns += countRuns(here, nCols);
+        }
+        start.resize(nRuns);
+        length.resize(nRuns);
+        parent.resize(nRuns);
+
+        vector<int>& row = m_bandRow[b];
+        size_t half = (nCols + 1) / 2 + 1;
+        row.resize(2 * half);
+        int* begins = row.data();
+        int* ends = begins + half;
+        for (int r = r0; r < r1; r++)
+        {
+            int rowFirst = m_rowFirstRun[r];
+            int nFound = findRuns(walls + static_cast<size_t>(r) * nCols, nCols, begins, ends);
+            for (int k = 0; k < nFound; k++)
+            {
+                start[rowFirst + k] = begins[k];
+                length[rowFirst + k] = ends[k] - begins[k];
+                parent[rowFirst + k] = rowFirst + k;
+            }
+            if (r > r0)
+                joinRows(start.data(), length.data(), parent.data(), m_rowFirstRun[r - 1],
+                         rowFirst, rowFirst, rowFirst + nFound, nullptr);
+        }
+        for (size_t j = 0; j < parent.size(); j++)
+            parent[j] = findRoot(parent.data(), static_cast<int>(j), nullptr);
+    });
+
+    // Number the runs across all bands, in cell order
+    vector<int>& firstRun = m_firstRun;
+    firstRun.assign(rowBands + 1, 0);
+    firstRun[1] = static_cast<int>(m_runStart.size());
+    for (int b = 1; b < rowBands; b++)
+        firstRun[b + 1] = firstRun[b] + static_cast<int>(m_bandStart[b].size());
+    int nRuns = firstRun[rowBands];
+    vector<int>& parent = m_parent;
+    m_runStart.resize(nRuns);
+    m_runLength.resize(nRuns);
+    parent.resize(nRuns);
+    m_rowFirstRun[nRows] = nRuns;
+    forEachBand(rowBands, [&](int b) {
+        if (b == 0)
+            return;
+        int offset = firstRun[b];
+        for (size_t j = 0; j < m_bandStart[b].size(); j++)
+        {
+            m_runStart[offset + j] = m_bandStart[b][j];
+            m_runLength[offset + j] = m_bandLength[b][j];
+            parent[offset + j] = offset + m_bandParent[b][j];
+        }
+        for (int r = bandStart(nRows, rowBands, b); r < bandStart(nRows, rowBands, b + 1); r++)
+            m_rowFirstRun[r] += offset;
+    });
+
+    // Join each band to the one above along their shared edge.  Only roots
+    // and the runs on the edge change; touched remembers them so that
+    // afterwards every run is at most two steps from its final root.
+    vector<int>& touched = m_touched;
+    touched.clear();
+    for (int b = 1; b < rowBands; b++)
+    {
+        int r = bandStart(nRows, rowBands, b);
+        joinRows(m_runStart.data(), m_runLength.data(), parent.data(), m_rowFirstRun[r - 1],
+                 m_rowFirstRun[r], m_rowFirstRun[r], m_rowFirstRun[r + 1], &touched);
+    }
+    for (size_t k = 0; k < touched.size(); k++)
+        parent[touched[k]] = findRoot(parent.data(), touched[k], nullptr);
+
+    // Regions are numbered by their first run.  Roots get their number
+    // first, then every other run copies its root's.
+    vector<int>& firstId = m_firstId;
+    firstId.assign(rowBands + 1, 1);
+    forEachBand(rowBands, [&](int b) {
+        int nRoots = 0;
+        for (int j = firstRun[b]; j < firstRun[b + 1]; j++)
+            nRoots += (parent[parent[j]] == j);
+        firstId[b + 1] = nRoots;
+    });
+    for (int b = 0; b < rowBands; b++)
+        firstId[b + 1] += firstId[b];
+    int nRegions = firstId[rowBands] - 1;
+    vector<int>& runRegion = m_runRegion;
+    runRegion.resize(nRuns);
+    forEachBand(rowBands, [&](int b) {
+        int id = firstId[b];
+        for (int j = firstRun[b]; j < firstRun[b + 1]; j++)
+            if (parent[parent[j]] == j)
+                runRegion[j] = id++;
+    });
+    forEachBand(rowBands, [&](int b) {
+        for (int j = firstRun[b]; j < firstRun[b + 1]; j++)
+            if (parent[parent[j]] != j)
+                runRegion[j] = runRegion[parent[parent[j]]];
+    });
+
+    m_regionSize.assign(nRegions + 1, 0);
+    for (int j = 0; j < nRuns; j++)
+        m_regionSize[runRegion[j]] += m_runLength[j];
+    for (int k = 1; k <= nRegions; k++)
+        if (m_largest == 0 || m_regionSize[k] > m_regionSize[m_largest])
+            m_largest = k;
+}
+
+size_t WallTopology::memoryUsed() const
+{
+    size_t total = sizeof(WallTopology) + m_capacity * sizeof(unsigned char)
+        + (m_rowFirstRun.capacity() + m_runStart.capacity() + m_runLength.capacity()
+            + m_runRegion.capacity()) * sizeof(int)
+        + m_regionSize.capacity() * sizeof(long long)
+        + (m_bandStart.capacity() + m_bandLength.capacity() + m_bandParent.capacity()
+            + m_bandRow.capacity()) * sizeof(vector<int>)
+        + (m_firstRun.capacity() + m_firstId.capacity() + m_parent.capacity()
+            + m_touched.capacity()) * sizeof(int);
+    for (size_t b = 0; b < m_bandStart.size(); b++)
+        total += (m_bandStart[b].capacity() + m_bandLength[b].capacity()
+            + m_bandParent[b].capacity() + m_bandRow[b].capacity()) * sizeof(int);
+    return total;
+}
+
+}  // namespace cyborgs
@@ -0,0 +1,661 @@
+// tests.cpp
+//
+// Checks the library's fast paths against plain reference versions of the
+// same computations.  Run by ctest; exits nonzero if any check fails.
+
+#include "cyborgs/cyborgs.h"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+using namespace std;
+using namespace cyborgs;
+
+// Every allocation is counted, for checking code that claims to make none
+long nAllocations = 0;
+
+void* operator new(size_t n)
+{
+    nAllocations++;
+    void* p = malloc(n == 0 ? 1 : n);
+    if (p == nullptr)
+        throw bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+namespace
+{
+    int nFailed = 0;
+
+    void check(bool ok, const string& what)
+    {
+        if (!ok)
+        {
+            if (nFailed < 20)
+                cout << "***** FAILED: " << what << endl;
+            nFailed++;
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    //  Wall topology
+    ///////////////////////////////////////////////////////////////////////
+
+    // Regions labelled by a serial flood fill, in the order their first
+    // cells appear row by row, which is how WallTopology numbers them too
+    int floodFill(const vector<bool>& walls, int rows, int cols,
+                  vector<int>& label, vector<long long>& size)
+    {
+        label.assign(walls.size(), 0);
+        size.assign(1, 0);
+        int nRegions = 0;
+        vector<int> stack;
+        for (size_t s = 0; s < walls.size(); s++)
+        {
+            if (walls[s] || label[s] != 0)
+                continue;
+            nRegions++;
+            size.push_back(0);
+            label[s] = nRegions;
+            stack.push_back(static_cast<int>(s));
+            while (!stack.empty())
+            {
+                int i = stack.back();
+                stack.pop_back();
+                size[nRegions]++;
+                int r = i / cols;
+                int c = i % cols;
+                int next[4] = { r > 0 ? i - cols : -1, c < cols - 1 ? i + 1 : -1,
+                                r < rows - 1 ? i + cols : -1, c > 0 ? i - 1 : -1 };
+                for (int j : next)
+                {
+                    if (j >= 0 && !walls[j] && label[j] == 0)
+                    {
+                        label[j] = nRegions;
+                        stack.push_back(j);
+                    }
+                }
+            }
+        }
+        return nRegions;
+    }
+
+    // Checks a topology built fresh, or else reuse rebuilt in place
+    void checkTopology(int rows, int cols, int wallPct, int nThreads,
+                       WallTopology* reuse = nullptr)
+    {
+        vector<bool> walls(static_cast<size_t>(rows) * cols);
+        for (size_t i = 0; i < walls.size(); i++)
+            walls[i] = (randInt(0, 99) < wallPct);
+        unique_ptr<bool[]> grid(new bool[walls.size()]);
+        for (size_t i = 0; i < walls.size(); i++)
+            grid[i] = walls[i];
+        unique_ptr<WallTopology> fresh;
+        if (reuse == nullptr)
+        {
+            fresh.reset(new WallTopology(grid.get(), rows, cols, nThreads));
+            reuse = fresh.get();
+        }
+        else
+            reuse->rebuild(grid.get(), rows, cols, nThreads);
+        const WallTopology& t = *reuse;
+
+        string what = string(fresh ? "topology" : "rebuilt topology") + " of "
+            + to_string(rows) + " by " + to_string(cols)
+            + " with " + to_string(nThreads) + " threads";
+        vector<int> label;
+        vector<long long> size;
+        int nRegions = floodFill(walls, rows, cols, label, size);
+        check(t.regionCount() == nRegions, what + ": region count");
+        if (t.regionCount() != nRegions)
+            return;
+        int largest = 0;
+        for (int k = 1; k <= nRegions; k++)
+        {
+            check(t.regionSize(k) == size[k], what + ": region size");
+            if (largest == 0 || size[k] > size[largest])
+                largest = k;
+        }
+        check(t.largestRegion() == largest, what + ": largest region");
+
+        const int dr[NUMDIRS] = { -1, 0, 1, 0 };
+        const int dc[NUMDIRS] = { 0, 1, 0, -1 };
+        bool ok = true;
+        for (int r = 1; r <= rows && ok; r++)
+        {
+            for (int c = 1; c <= cols && ok; c++)
+            {
+                size_t i = static_cast<size_t>(r - 1) * cols + (c - 1);
+                ok = (t.region(r, c) == label[i]);
+                int mask = 0;
+                for (int dir = 0; dir < NUMDIRS && !walls[i]; dir++)
+                {
+                    int n = 0;
+                    for (int rr = r + dr[dir], cc = c + dc[dir];
+                         rr >= 1 && rr <= rows && cc >= 1 && cc <= cols
+                            && !walls[static_cast<size_t>(rr - 1) * cols + (cc - 1)];
+                         rr += dr[dir], cc += dc[dir])
+                        n++;
+                    ok = ok && (t.wallDistance(r, c, dir) == n);
+                    mask |= (n > 0) << dir;
+                }
+                ok = ok && (t.moves(r, c) == mask);
+            }
+        }
+        check(ok, what + ": per-cell tables");
+    }
+
+    void testTopology()
+    {
+        seedRandom(3);
+        for (int i = 0; i < 300; i++)
+            checkTopology(randInt(1, 40), randInt(1, 40), randInt(0, 60), 0);
+
+        // Big enough to be split into bands, so the stitching is exercised
+        for (int i = 0; i < 3; i++)
+            checkTopology(randInt(500, 700), randInt(500, 700), randInt(0, 50), 4);
+        checkTopology(1, 300000, 30, 4);
+        checkTopology(300000, 1, 30, 4);
+
+        // Rebuilt in place over grids growing, shrinking and changing shape
+        bool none = false;
+        WallTopology t(&none, 1, 1);
+        for (int i = 0; i < 100; i++)
+            checkTopology(randInt(1, 40), randInt(1, 40), randInt(0, 60), 0, &t);
+        checkTopology(600, 500, 20, 4, &t);
+        checkTopology(500, 600, 30, 3, &t);
+        checkTopology(20, 30, 10, 0, &t);
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    //  recommendMove
+    ///////////////////////////////////////////////////////////////////////
+
+    // The rule as first written: in each direction, the distance to the
+    // nearest cyborg or wall, or to the edge if there is none; stand if all
+    // four are equal, else take the first direction with the longest.
+    bool referenceMove(const Arena& a, int r, int c, int& bestDir)
+    {
+        const int dr[NUMDIRS] = { -1, 0, 1, 0 };
+        const int dc[NUMDIRS] = { 0, 1, 0, -1 };
+        int room[NUMDIRS];
+        for (int dir = 0; dir < NUMDIRS; dir++)
+        {
+            int n = 0;
+            int rr = r + dr[dir];
+            int cc = c + dc[dir];
+            room[dir] = -1;
+            for ( ; rr >= 1 && rr <= a.rows() && cc >= 1 && cc <= a.cols();
+                 rr += dr[dir], cc += dc[dir])
+            {
+                n++;
+                if (a.hasWallAt(rr, cc) || a.numberOfCyborgsAt(rr, cc) > 0)
+                {
+                    room[dir] = n;
+                    break;
+                }
+            }
+            if (room[dir] < 0)
+                room[dir] = n;
+        }
+        if (room[0] == room[1] && room[0] == room[2] && room[0] == room[3])
+            return false;
+        bestDir = 0;
+        for (int dir = 1; dir < NUMDIRS; dir++)
+            if (room[dir] > room[bestDir])
+                bestDir = dir;
+        return true;
+    }
+
+    void testRecommendMove()
+    {
+        seedRandom(5);
+        int nBad = 0;
+        for (int t = 0; t < 5000; t++)
+        {
+            int rows = randInt(1, 30);
+            int cols = randInt(1, 30);
+            int nCyborgs = randInt(0, min(rows * cols - 1, 300));
+            Arena a(rows, cols, 3, 300);
+            for (int r = 1; r <= rows; r++)
+                for (int c = 1; c <= cols; c++)
+                    if (randInt(0, 99) < 15)
+                        a.placeWallAt(r, c);
+            for (int k = 0, placed = 0; k < nCyborgs * 3 && placed < nCyborgs; k++)
+            {
+                int r = randInt(1, rows);
+                int c = randInt(1, cols);
+                if (!a.hasWallAt(r, c) && a.addCyborg(r, c, randInt(1, 3)))
+                    placed++;
+            }
+            for (int q = 0; q < 5; q++)
+            {
+                int r = randInt(1, rows);
+                int c = randInt(1, cols);
+                if (a.hasWallAt(r, c))
+                    continue;
+                int want = BADDIR;
+                int got = BADDIR;
+                bool moves = referenceMove(a, r, c, want);
+                if (recommendMove(a, r, c, got) != moves || (moves && got != want))
+                    nBad++;
+            }
+        }
+        check(nBad == 0, "recommendMove disagrees with the reference "
+            + to_string(nBad) + " times");
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    //  Undo and redo
+    ///////////////////////////////////////////////////////////////////////
+
+    // Everything a turn can change, for comparing states
+    vector<int> stateOf(const Arena& a)
+    {
+        vector<int> s;
+        for (int ch = 1; ch <= a.channels(); ch++)
+            s.push_back(a.cyborgCountOn(ch));
+        for (int i = 0; i < a.cyborgCount(); i++)
+        {
+            const Cyborg& cy = a.cyborg(i);
+            s.insert(s.end(), { cy.row(), cy.col(), cy.channel(), cy.health() });
+        }
+        s.insert(s.end(), { a.player()->row(), a.player()->col(), a.player()->isDead() });
+        return s;
+    }
+
+    void testHistory()
+    {
+        int nBad = 0;
+        for (int trial = 0; trial < 200; trial++)
+        {
+            seedRandom(trial);
+            int size = randInt(3, 30);
+            int nChannels = randInt(1, 6);
+            int maxTurns = randInt(1, 40);
+            int keyframeInterval = randInt(1, 10);
+            int nCyborgs = randInt(0, size * size / 2);
+            Arena a(size, size, nChannels, nCyborgs);
+            populateArena(a, nCyborgs);
+            a.enableHistory(maxTurns, keyframeInterval);
+            const TurnHistory* h = a.history();
+            long long first = h->turn();
+
+            // states[t - first] is the arena as of turn t
+            vector<vector<int>> states(1, stateOf(a));
+            int nTurns = randInt(1, 120);
+            for (int t = 0; t < nTurns; t++)
+            {
+                a.beginTurn();
+                int dir;
+                if (recommendMove(a, a.player()->row(), a.player()->col(), dir))
+                    a.player()->move(dir);
+                a.moveCyborgs(randInt(0, nChannels), randInt(-1, 3));
+                states.resize(h->turn() - first);
+                states.push_back(stateOf(a));
+
+                // Now and then back up a few turns and play on from there
+                if (randInt(0, 9) == 0)
+                {
+                    for (int k = randInt(1, 5); k > 0 && a.undoTurn(); k--)
+                        nBad += (stateOf(a) != states[h->turn() - first]);
+                }
+            }
+
+            for (int s = 0; s < 50; s++)
+            {
+                long long t = randInt(static_cast<int>(h->oldestTurn()),
+                                      static_cast<int>(h->newestTurn()));
+                if (!a.seekTurn(t) || stateOf(a) != states[t - first])
+                {
+                    nBad++;
+                    continue;
+                }
+                if (randInt(0, 1) == 0)
+                {
+                    if (a.undoTurn())
+                        nBad += (stateOf(a) != states[t - 1 - first]);
+                }
+                else if (a.redoTurn())
+                    nBad += (stateOf(a) != states[t + 1 - first]);
+            }
+            nBad += a.seekTurn(h->oldestTurn() - 1);
+            nBad += a.seekTurn(h->newestTurn() + 1);
+        }
+        check(nBad == 0, "undo, redo or seek reached the wrong state "
+            + to_string(nBad) + " times");
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    //  Session pooling
+    ///////////////////////////////////////////////////////////////////////
+
+    // Once the host has warmed up, opening and closing sessions allocates
+    // nothing: not the arena, not the session, not the wall topology.  The
+    // topology's working space grows to fit the most wall runs and regions
+    // seen, so the second pass over the same boards is the one checked.
+    void testSessionChurn()
+    {
+        SessionHost host;
+        for (unsigned int seed = 0; seed < 1000; seed++)
+            host.close(host.open(MAXROWS, MAXCOLS, MAXCYBORGS / 2, seed));
+        long before = nAllocations;
+        for (unsigned int seed = 0; seed < 1000; seed++)
+            host.close(host.open(MAXROWS, MAXCOLS, MAXCYBORGS / 2, seed));
+        long n = nAllocations - before;
+        check(n == 0, "session churn made " + to_string(n) + " allocations");
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    //  Broadcast planner
+    ///////////////////////////////////////////////////////////////////////
+
+    // The plan and its estimate depend on the seed, not on how many threads
+    // search, and the caller's random engine comes back as it was.  The
+    // budget is generous so that no search is cut short.
+    void testPlanner()
+    {
+        for (unsigned int seed = 1; seed <= 4; seed++)
+        {
+            seedRandom(seed);
+            Arena a(MAXROWS, MAXCOLS);
+            populateArena(a, 20 * seed);
+            PlannerOptions opts;
+            opts.horizon = 8;
+            opts.beamWidth = 8;
+            opts.particles = 16;
+            opts.evalRollouts = 200;
+            opts.timeBudget = 1000;
+            opts.seed = seed;
+
+            Plan plans[2];
+            const int nThreads[2] = { 1, 4 };
+            for (int k = 0; k < 2; k++)
+            {
+                opts.threads = nThreads[k];
+                seedRandom(1000 + seed);
+                int expected = randInt(0, 1000000000);
+                seedRandom(1000 + seed);
+                plans[k] = planBroadcasts(a, opts);
+                check(randInt(0, 1000000000) == expected,
+                    "planBroadcasts changed the caller's random engine");
+            }
+
+            const Plan& p = plans[0];
+            const Plan& q = plans[1];
+            bool same = !p.timedOut && !q.timedOut && p.steps.size() == q.steps.size()
+                && p.winProbability == q.winProbability && p.rollouts == q.rollouts
+                && p.depthSearched == q.depthSearched && p.simulatedTurns == q.simulatedTurns;
+            for (size_t s = 0; same && s < p.steps.size(); s++)
+                same = (p.steps[s].channel == q.steps[s].channel && p.steps[s].dir == q.steps[s].dir);
+            check(same, "plans for seed " + to_string(seed) + " differ between 1 and 4 threads");
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    //  Frame buffer
+    ///////////////////////////////////////////////////////////////////////
+
+    // Contents that depend on the turn, varying in length, so a frame torn
+    // between two publishes would not match its own turn
+    string gridFor(long long turn)
+    {
+        return string(10 + turn % 50, static_cast<char>('a' + turn % 26)) + to_string(turn);
+    }
+
+    // A writer publishes numbered frames as fast as it can while a reader
+    // acquires them.  The reader must see turns only ever increase, end on
+    // the last one, and find every frame it takes whole, even after giving
+    // the writer a chance to run while it holds the frame.
+    void testFrameBuffer()
+    {
+        const long long nFrames = 200000;
+        FrameBuffer frames;
+        thread writer([&] {
+            for (long long turn = 1; turn <= nFrames; turn++)
+            {
+                Frame& f = frames.back();
+                f.grid = gridFor(turn);
+                f.turn = turn;
+                f.game = turn / 7;
+                f.cyborgs = static_cast<int>(turn % 1000);
+                f.playerDead = (turn % 3 == 0);
+                frames.publish();
+            }
+        });
+
+        long long last = 0;
+        long long nAcquired = 0;
+        int nBad = 0;
+        while (last < nFrames)
+        {
+            if (!frames.acquire())
+            {
+                this_thread::yield();
+                continue;
+            }
+            const Frame& f = frames.front();
+            long long turn = f.turn;
+            this_thread::yield();
+            nAcquired++;
+            nBad += (f.turn != turn || f.turn <= last);
+            nBad += (f.grid != gridFor(f.turn) || f.game != f.turn / 7
+                || f.cyborgs != f.turn % 1000 || f.playerDead != (f.turn % 3 == 0));
+            last = max(last, f.turn);
+        }
+        writer.join();
+        check(nBad == 0, "frame buffer handed the reader " + to_string(nBad)
+            + " stale or torn frames of " + to_string(nAcquired));
+        check(frames.published() == nFrames, "frame buffer miscounted publishes");
+        check(!frames.acquire(), "frame buffer offered a frame twice");
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    //  Cohort mode
+    ///////////////////////////////////////////////////////////////////////
+
+    // Upper regularized incomplete gamma Q(s, x), series below s + 1 and a
+    // continued fraction above it
+    double gammaQ(double s, double x)
+    {
+        if (x <= 0)
+            return 1;
+        double lead = exp(-x + s * log(x) - lgamma(s));
+        if (x < s + 1)
+        {
+            double term = 1 / s;
+            double sum = term;
+            for (int n = 1; n < 500 && term > sum * 1e-15; n++)
+            {
+                term *= x / (s + n);
+                sum += term;
+            }
+            return 1 - sum * lead;
+        }
+        double b = x + 1 - s;
+        double c = 1e300;
+        double d = 1 / b;
+        double h = d;
+        for (int n = 1; n < 500; n++)
+        {
+            double an = -n * (n - s);
+            b += 2;
+            d = an * d + b;
+            d = (fabs(d) < 1e-300 ? 1e-300 : d);
+            c = b + an / c;
+            c = (fabs(c) < 1e-300 ? 1e-300 : c);
+            d = 1 / d;
+            h *= d * c;
+            if (fabs(d * c - 1) < 1e-15)
+                break;
+        }
+        return h * lead;
+    }
+
+    // Two-sample chi-square on histograms a and b built from the same number
+    // of trials.  Adjacent bins are pooled until each holds at least 10
+    // observations between the two samples.  Returns the p-value.
+    double chiSquare(const vector<long>& a, const vector<long>& b)
+    {
+        double chi2 = 0;
+        int nBins = 0;
+        long pa = 0;
+        long pb = 0;
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            pa += a[i];
+            pb += b[i];
+            if (pa + pb < 10 && i + 1 < a.size())
+                continue;
+            if (pa + pb > 0)
+            {
+                chi2 += static_cast<double>(pa - pb) * (pa - pb) / (pa + pb);
+                nBins++;
+            }
+            pa = 0;
+            pb = 0;
+        }
+        int dof = nBins - 1;
+        return dof > 0 ? gammaQ(dof / 2.0, chi2 / 2) : 1;
+    }
+
+    // Aggregate mode must be a faithful model of the individual one.  Both
+    // replay the same broadcasts from the same start for many trials (always
+    // NORTH, so cyborgs pile into the top wall and die); the survivor count
+    // and the number of cyborgs in the top-left quadrant at the end are
+    // compared with a two-sample chi-square, failing below p = 1e-4.
+    void testCohortDistribution()
+    {
+        const int size = 10;
+        const int nCyborgs = 40;
+        const int nTurns = 12;
+        const int nTrials = 20000;
+        seedRandom(32);
+        Arena start(size, size, MAXCHANNELS, nCyborgs);
+        populateArena(start, nCyborgs);
+        Arena a(size, size, MAXCHANNELS, nCyborgs);
+
+        vector<long> survivors[2];
+        vector<long> quadrant[2];
+        for (int mode = 0; mode < 2; mode++)
+        {
+            survivors[mode].assign(nCyborgs + 1, 0);
+            quadrant[mode].assign(nCyborgs + 1, 0);
+        }
+        for (int t = 0; t < nTrials; t++)
+        {
+            a.copyFrom(start);
+            CohortArena ca(start);
+            for (int turn = 0; turn < nTurns; turn++)
+            {
+                a.moveCyborgs(1 + turn % MAXCHANNELS, NORTH);
+                ca.moveCyborgs(1 + turn % MAXCHANNELS, NORTH);
+            }
+            long inA = 0;
+            long inCa = 0;
+            for (int r = 1; r <= size / 2; r++)
+            {
+                for (int c = 1; c <= size / 2; c++)
+                {
+                    inA += a.numberOfCyborgsAt(r, c);
+                    inCa += ca.numberOfCyborgsAt(r, c);
+                }
+            }
+            survivors[0][a.cyborgCount()]++;
+            survivors[1][ca.cyborgCount()]++;
+            quadrant[0][inA]++;
+            quadrant[1][inCa]++;
+        }
+
+        double pSurvivors = chiSquare(survivors[0], survivors[1]);
+        double pQuadrant = chiSquare(quadrant[0], quadrant[1]);
+        check(pSurvivors >= 1e-4, "cohort survivors differ in distribution, p = "
+            + to_string(pSurvivors));
+        check(pQuadrant >= 1e-4, "cohort cyborgs in a quadrant differ in distribution, p = "
+            + to_string(pQuadrant));
+    }
+
+    // The scenario above never gathers more than a handful of cyborgs on a
+    // cell, so every cohort rolls per cyborg.  Here hundreds start on one
+    // cell beside a wall and walk at random for two turns, so the cohorts
+    // are split by the chain of binomials, blocked direction included; the
+    // counts left on the start cell and one step north are compared.
+    void testCohortSplit()
+    {
+        const int size = 9;
+        const int nCyborgs = 300;
+        const int nTurns = 2;
+        const int nTrials = 4000;
+        seedRandom(33);
+        Arena start(size, size, 2, nCyborgs);
+        start.placeWallAt(5, 6);
+        start.addPlayer(1, 1);
+        for (int k = 0; k < nCyborgs; k++)
+            start.addCyborg(5, 5, 1);
+        Arena a(size, size, 2, nCyborgs);
+
+        vector<long> here[2];
+        vector<long> north[2];
+        for (int mode = 0; mode < 2; mode++)
+        {
+            here[mode].assign(nCyborgs + 1, 0);
+            north[mode].assign(nCyborgs + 1, 0);
+        }
+        for (int t = 0; t < nTrials; t++)
+        {
+            a.copyFrom(start);
+            CohortArena ca(start);
+            for (int turn = 0; turn < nTurns; turn++)
+            {
+                a.moveCyborgs(2, NORTH);  // nobody is on channel 2
+                ca.moveCyborgs(2, NORTH);
+            }
+            here[0][a.numberOfCyborgsAt(5, 5)]++;
+            here[1][ca.numberOfCyborgsAt(5, 5)]++;
+            north[0][a.numberOfCyborgsAt(4, 5)]++;
+            north[1][ca.numberOfCyborgsAt(4, 5)]++;
+        }
+
+        double pHere = chiSquare(here[0], here[1]);
+        double pNorth = chiSquare(north[0], north[1]);
+        check(pHere >= 1e-4, "large cohorts left in place differ in distribution, p = "
+            + to_string(pHere));
+        check(pNorth >= 1e-4, "large cohorts moved north differ in distribution, p = "
+            + to_string(pNorth));
+    }
+}
+
+int main()
+{
+    testTopology();
+    testRecommendMove();
+    testHistory();
+    testSessionChurn();
+    testPlanner();
+    testFrameBuffer();
+    testCohortDistribution();
+    testCohortSplit();
+    if (nFailed != 0)
+    {
+        cout << nFailed << " checks failed" << endl;
+        return 1;
+    }
+    cout << "All checks passed" << endl;
+}